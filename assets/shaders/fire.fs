@@ -1,7 +1,8 @@
 #version 100
 precision highp float;
 
-uniform sampler2D texture0;          // Noise texture
+uniform sampler2D texture0;          // Sprite texture
+uniform vec4 noiseRect;              // Noise sprite in texture0 uv space: x, y, width, height
 uniform vec3 flameColor;             // Color of the flame
 uniform float yOffset;               // Vertical offset
 uniform float animationSpeed;        // Speed of the flame animation
@@ -10,17 +11,20 @@ uniform float time;                  // Time for animation
 varying vec2 fragTexCoord;
 
 void main() {
+    // UVs within the noise sprite
+    vec2 localUv = (fragTexCoord - noiseRect.xy) / noiseRect.zw;
+
     // Offset UVs vertically based on time to animate the flame
-    vec2 uv = fragTexCoord;
+    vec2 uv = localUv;
     uv.y = mod(uv.y + time * animationSpeed, 1.0);
 
     // Sample the noise texture at the offset UVs
-    vec4 noiseColor = texture2D(texture0, uv);
+    vec4 noiseColor = texture2D(texture0, noiseRect.xy + uv * noiseRect.zw);
 
     // Manipulate color based on vertical position
     vec4 color = noiseColor;
-    color.rgb += vec3(fragTexCoord.y - yOffset);
-    color.rgb = step(color.rgb, vec3(0.3));
+    color.rgb += vec3(localUv.y - yOffset);
+    color.rgb = step(color.rgb, vec3(0.3)); // FIRE_THRESHOLD in src/fire.h bakes the same flame
     color.rgb = vec3(1.0) - color.rgb;
     color.a = color.r;
     color.rgb *= flameColor;
@@ -0,0 +1,39 @@
+#version 100
+#extension GL_OES_standard_derivatives : enable
+precision highp float;               // texel math in pixels, fp16 would quantize the filter fraction
+
+uniform sampler2D texture0;          // Sprite texture, glyph distance in alpha
+uniform vec2 textureSize;            // Sprite texture size in pixels
+uniform float smoothing;             // Edge width when derivatives aren't available
+
+varying vec2 fragTexCoord;
+varying vec4 fragColor;
+
+// The sprite texture is point filtered for the pixel art, so filter the distance here
+float SampleDistance(vec2 uv) {
+    vec2 st = uv * textureSize - 0.5;
+    vec2 base = floor(st);
+    vec2 f = st - base;
+
+    float a = texture2D(texture0, (base + vec2(0.5, 0.5)) / textureSize).a;
+    float b = texture2D(texture0, (base + vec2(1.5, 0.5)) / textureSize).a;
+    float c = texture2D(texture0, (base + vec2(0.5, 1.5)) / textureSize).a;
+    float d = texture2D(texture0, (base + vec2(1.5, 1.5)) / textureSize).a;
+
+    return mix(mix(a, b, f.x), mix(c, d, f.x), f.y);
+}
+
+void main() {
+    // 0.5 is the glyph outline
+    float dist = SampleDistance(fragTexCoord) - 0.5;
+
+#ifdef GL_OES_standard_derivatives
+    float width = length(vec2(dFdx(dist), dFdy(dist)));
+#else
+    float width = smoothing;
+#endif
+
+    float alpha = smoothstep(-width, width, dist);
+
+    gl_FragColor = vec4(fragColor.rgb, fragColor.a * alpha);
+}
@@ -0,0 +1,455 @@
+#include "assets.h"
+#include "fire.h"
+#include "sprites.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(PLATFORM_WEB)
+#include <pthread.h>
+#endif
+
+// Decoding (pngs, the wav, reading the music and shader files) happens on a
+// thread per asset into CPU memory. Everything that touches the GL context or the
+// audio device runs on the main thread in UpdateAssetLoading.
+
+enum AssetKind
+{
+	ASSET_KIND_TEXTURE,
+	ASSET_KIND_SOUND,
+	ASSET_KIND_MUSIC,
+	ASSET_KIND_SHADER,
+	ASSET_KIND_FLIPBOOK,	// a texture baked from the image on the decoding thread
+};
+
+struct AssetEntry
+{
+	enum AssetKind kind;
+	const char* path;
+	const char* fileType;
+};
+
+static const struct AssetEntry assetTable[ASSET_COUNT] = {
+	[ASSET_SPRITES] = { ASSET_KIND_TEXTURE, "assets/sprites.png" },
+	[ASSET_SDF_SHADER] = { ASSET_KIND_SHADER, "assets/shaders/sdf.fs" },
+	[ASSET_START_PAGE] = { ASSET_KIND_TEXTURE, "assets/start_page.png" },
+	[ASSET_HELP_PAGE] = { ASSET_KIND_TEXTURE, "assets/help_page.png" },
+	[ASSET_FIRE_SHADER] = { ASSET_KIND_SHADER, "assets/shaders/fire.fs" },
+	[ASSET_FIRE_FLIPBOOK] = { ASSET_KIND_FLIPBOOK, "assets/noise.png" },
+	[ASSET_CARD_SOUND] = { ASSET_KIND_SOUND, "assets/card.wav" },
+	[ASSET_FIRE_MUSIC] = { ASSET_KIND_MUSIC, "assets/flame.mp3", ".mp3" },
+	[ASSET_BG_MUSIC] = { ASSET_KIND_MUSIC, "assets/bg_music.ogg", ".ogg" },
+};
+
+#define COMMON_ASSETS (ASSET_BIT(ASSET_SPRITES) | ASSET_BIT(ASSET_SDF_SHADER) | ASSET_BIT(ASSET_BG_MUSIC))
+#define FIRE_ASSETS (ASSET_BIT(ASSET_FIRE_SHADER) | ASSET_BIT(ASSET_FIRE_MUSIC))
+#define STATE_COUNT (LOST + 1)
+
+// What each state draws or plays, see the switches in main.c
+static const uint32_t stateAssets[STATE_COUNT] = {
+	[START] = COMMON_ASSETS | FIRE_ASSETS | ASSET_BIT(ASSET_START_PAGE),
+	[HOWTO] = COMMON_ASSETS | ASSET_BIT(ASSET_FIRE_MUSIC) | ASSET_BIT(ASSET_HELP_PAGE),
+	[PLAYING] = COMMON_ASSETS | FIRE_ASSETS | ASSET_BIT(ASSET_CARD_SOUND),
+	[END] = COMMON_ASSETS,
+	[WON] = COMMON_ASSETS,
+	[LOST] = COMMON_ASSETS | FIRE_ASSETS,
+};
+
+// Transitions the game can make, must follow the fadeIn.to assignments in game.c
+static const uint32_t stateSuccessors[STATE_COUNT] = {
+	[START] = 1u << HOWTO,
+	[HOWTO] = 1u << PLAYING,
+	[PLAYING] = (1u << WON) | (1u << LOST) | (1u << END),
+	[END] = 0,
+	[WON] = 1u << PLAYING,
+	[LOST] = 1u << PLAYING,
+};
+
+struct DecodedAsset
+{
+	Image image;
+	Wave wave;
+	unsigned char* fileData;
+	unsigned int fileSize;
+	char* text;
+	int isDecoded;	// set by the decoding thread, read with acquire by the main thread
+#if !defined(PLATFORM_WEB)
+	pthread_t thread;
+	bool hasThread;
+#endif
+};
+
+static struct DecodedAsset decoded[ASSET_COUNT];
+
+// Music streams decode from this memory while playing, so it lives until the music is unloaded
+static unsigned char* musicData[ASSET_COUNT];
+
+// Set once by StartLoadingAssets, before the simulation thread reads it
+static bool isFireBaked = false;
+
+uint32_t GetStateAssets(enum State state)
+{
+	uint32_t mask = stateAssets[state];
+	if (isFireBaked && (mask & ASSET_BIT(ASSET_FIRE_SHADER)))
+	{
+		mask = (mask & ~ASSET_BIT(ASSET_FIRE_SHADER)) | ASSET_BIT(ASSET_FIRE_FLIPBOOK);
+	}
+	return mask;
+}
+
+// Steps from state to the first state needing each asset, -1 when none will
+static void GetAssetDistances(enum State state, int distances[ASSET_COUNT])
+{
+	for (int i = 0; i < ASSET_COUNT; i++) distances[i] = -1;
+
+	uint32_t visited = 1u << state;
+	uint32_t frontier = visited;
+	for (int distance = 0; frontier != 0; distance++)
+	{
+		uint32_t next = 0;
+		for (int s = 0; s < STATE_COUNT; s++)
+		{
+			if (!(frontier & (1u << s))) continue;
+
+			for (int i = 0; i < ASSET_COUNT; i++)
+			{
+				if ((GetStateAssets((enum State)s) & ASSET_BIT(i)) && distances[i] < 0) distances[i] = distance;
+			}
+			next |= stateSuccessors[s];
+		}
+
+		frontier = next & ~visited;
+		visited |= next;
+	}
+}
+
+struct AssetConfig ParseAssetArgs(int argc, char** argv)
+{
+	struct AssetConfig config = { 0 };
+
+#if defined(PLATFORM_WEB)
+	config.budget = ASSET_WEB_BUDGET;
+#endif
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--asset-budget") == 0 && i + 1 < argc) config.budget = (size_t)atoi(argv[i + 1]) * 1024 * 1024;
+		else if (strcmp(argv[i], "--baked-fire") == 0) config.isFireBaked = true;
+	}
+
+	return config;
+}
+
+static void DecodeAsset(enum AssetId id)
+{
+	const struct AssetEntry* entry = &assetTable[id];
+	struct DecodedAsset* asset = &decoded[id];
+
+	switch (entry->kind)
+	{
+	case ASSET_KIND_TEXTURE:
+		asset->image = LoadImage(entry->path);
+		break;
+	case ASSET_KIND_SOUND:
+		asset->wave = LoadWave(entry->path);
+		break;
+	case ASSET_KIND_MUSIC:
+		asset->fileData = LoadFileData(entry->path, &asset->fileSize);
+		break;
+	case ASSET_KIND_SHADER:
+		asset->text = LoadFileText(entry->path);
+		break;
+	case ASSET_KIND_FLIPBOOK:
+	{
+		Image noise = LoadImage(entry->path);
+		asset->image = GenFireFlipbook(noise);
+		UnloadImage(noise);
+		break;
+	}
+	default:
+		break;
+	}
+
+	__atomic_store_n(&asset->isDecoded, 1, __ATOMIC_RELEASE);
+}
+
+#if !defined(PLATFORM_WEB)
+static void* DecodeThread(void* arg)
+{
+	DecodeAsset((enum AssetId)(intptr_t)arg);
+	return NULL;
+}
+#endif
+
+static void RequestAsset(struct Assets* assets, enum AssetId id)
+{
+	if (assets->status[id] != ASSET_UNLOADED) return;
+
+	decoded[id] = (struct DecodedAsset){ 0 };
+	assets->status[id] = ASSET_DECODING;
+
+#if defined(PLATFORM_WEB)
+	// No threads in the web build, decode right away
+	DecodeAsset(id);
+#else
+	decoded[id].hasThread = pthread_create(&decoded[id].thread, NULL, DecodeThread, (void*)(intptr_t)id) == 0;
+	if (!decoded[id].hasThread) DecodeAsset(id);
+#endif
+}
+
+static void UploadAsset(struct Assets* assets, enum AssetId id)
+{
+	struct DecodedAsset* asset = &decoded[id];
+	size_t size = 0;
+
+#if !defined(PLATFORM_WEB)
+	if (asset->hasThread) pthread_join(asset->thread, NULL);
+#endif
+
+	switch (assetTable[id].kind)
+	{
+	case ASSET_KIND_TEXTURE:
+	case ASSET_KIND_FLIPBOOK:
+		size = GetPixelDataSize(asset->image.width, asset->image.height, asset->image.format);
+		break;
+	case ASSET_KIND_SOUND:
+		size = (size_t)asset->wave.frameCount * asset->wave.channels * asset->wave.sampleSize / 8;
+		break;
+	case ASSET_KIND_MUSIC:
+		size = (size_t)asset->fileSize + ASSET_MUSIC_OVERHEAD;
+		break;
+	case ASSET_KIND_SHADER:
+		size = asset->text != NULL ? strlen(asset->text) : 0;
+		break;
+	default:
+		break;
+	}
+
+	switch (id)
+	{
+	case ASSET_SPRITES:
+		assets->spriteTexture = LoadTextureFromImage(asset->image);
+		assets->mx16Font = GetSpriteFont(assets->spriteTexture);
+		break;
+	case ASSET_START_PAGE:
+		assets->startPageTexture = LoadTextureFromImage(asset->image);
+		break;
+	case ASSET_HELP_PAGE:
+		assets->helpPageTexture = LoadTextureFromImage(asset->image);
+		break;
+	case ASSET_SDF_SHADER:
+		assets->sdfShader = LoadShaderFromMemory(NULL, asset->text);
+		break;
+	case ASSET_FIRE_SHADER:
+		assets->fireShader = LoadShaderFromMemory(NULL, asset->text);
+		break;
+	case ASSET_FIRE_FLIPBOOK:
+		assets->fireFlipbook = LoadTextureFromImage(asset->image);
+		break;
+	case ASSET_CARD_SOUND:
+		assets->cardSnd = LoadSoundFromWave(asset->wave);
+		UnloadWave(asset->wave);
+		break;
+	case ASSET_FIRE_MUSIC:
+		assets->fireMusic = LoadMusicStreamFromMemory(assetTable[id].fileType, asset->fileData, (int)asset->fileSize);
+		musicData[id] = asset->fileData;
+		break;
+	case ASSET_BG_MUSIC:
+		assets->bgMusic = LoadMusicStreamFromMemory(assetTable[id].fileType, asset->fileData, (int)asset->fileSize);
+		musicData[id] = asset->fileData;
+		break;
+	default:
+		break;
+	}
+
+	if (assetTable[id].kind == ASSET_KIND_TEXTURE || assetTable[id].kind == ASSET_KIND_FLIPBOOK) UnloadImage(asset->image);
+	if (assetTable[id].kind == ASSET_KIND_SHADER) UnloadFileText(asset->text);
+
+	assets->status[id] = ASSET_RESIDENT;
+	assets->sizes[id] = size;
+	assets->residentSize += size;
+	assets->readyMask |= ASSET_BIT(id);
+}
+
+static void EvictAsset(struct Assets* assets, enum AssetId id)
+{
+	switch (id)
+	{
+	case ASSET_SPRITES:
+		UnloadTexture(assets->spriteTexture);
+		assets->spriteTexture = (Texture2D){ 0 };
+		assets->mx16Font = (Font){ 0 };
+		break;
+	case ASSET_START_PAGE:
+		UnloadTexture(assets->startPageTexture);
+		assets->startPageTexture = (Texture2D){ 0 };
+		break;
+	case ASSET_HELP_PAGE:
+		UnloadTexture(assets->helpPageTexture);
+		assets->helpPageTexture = (Texture2D){ 0 };
+		break;
+	case ASSET_SDF_SHADER:
+		UnloadShader(assets->sdfShader);
+		assets->sdfShader = (Shader){ 0 };
+		break;
+	case ASSET_FIRE_SHADER:
+		UnloadShader(assets->fireShader);
+		assets->fireShader = (Shader){ 0 };
+		break;
+	case ASSET_FIRE_FLIPBOOK:
+		UnloadTexture(assets->fireFlipbook);
+		assets->fireFlipbook = (Texture2D){ 0 };
+		break;
+	case ASSET_CARD_SOUND:
+		UnloadSound(assets->cardSnd);
+		assets->cardSnd = (Sound){ 0 };
+		break;
+	case ASSET_FIRE_MUSIC:
+		UnloadMusicStream(assets->fireMusic);
+		assets->fireMusic = (Music){ 0 };
+		break;
+	case ASSET_BG_MUSIC:
+		UnloadMusicStream(assets->bgMusic);
+		assets->bgMusic = (Music){ 0 };
+		break;
+	default:
+		break;
+	}
+
+	if (musicData[id] != NULL)
+	{
+		UnloadFileData(musicData[id]);
+		musicData[id] = NULL;
+	}
+
+	assets->status[id] = ASSET_UNLOADED;
+	assets->residentSize -= assets->sizes[id];
+	assets->sizes[id] = 0;
+	assets->readyMask &= ~ASSET_BIT(id);
+}
+
+static void UploadDecodedAssets(struct Assets* assets)
+{
+	for (int i = 0; i < ASSET_COUNT; i++)
+	{
+		if (assets->status[i] == ASSET_DECODING && __atomic_load_n(&decoded[i].isDecoded, __ATOMIC_ACQUIRE))
+		{
+			UploadAsset(assets, (enum AssetId)i);
+		}
+	}
+}
+
+void StartLoadingAssets(struct Assets* assets, struct AssetConfig config, enum State state)
+{
+	*assets = (struct Assets){ .budget = config.budget, .isFireBaked = config.isFireBaked };
+	isFireBaked = config.isFireBaked;
+
+	for (int i = 0; i < ASSET_COUNT; i++)
+	{
+		if (GetStateAssets(state) & ASSET_BIT(i)) RequestAsset(assets, (enum AssetId)i);
+	}
+}
+
+uint32_t UpdateAssetLoading(struct Assets* assets, enum State state, enum State next)
+{
+	uint32_t needed = GetStateAssets(state) | GetStateAssets(next);
+
+	for (int i = 0; i < ASSET_COUNT; i++)
+	{
+		if (needed & ASSET_BIT(i)) RequestAsset(assets, (enum AssetId)i);
+	}
+
+	UploadDecodedAssets(assets);
+
+	int distances[ASSET_COUNT];
+	int nextDistances[ASSET_COUNT];
+	GetAssetDistances(state, distances);
+	GetAssetDistances(next, nextDistances);
+
+	for (int i = 0; i < ASSET_COUNT; i++)
+	{
+		// Steps until either state needs it, a fade is heading to next and may get there sooner
+		if (distances[i] < 0 || (nextDistances[i] >= 0 && nextDistances[i] < distances[i])) distances[i] = nextDistances[i];
+
+		// Never needed again
+		if (assets->status[i] == ASSET_RESIDENT && distances[i] < 0)
+		{
+			EvictAsset(assets, (enum AssetId)i);
+		}
+	}
+
+	while (assets->budget > 0 && assets->residentSize > assets->budget)
+	{
+		int farthest = -1;
+		for (int i = 0; i < ASSET_COUNT; i++)
+		{
+			if (assets->status[i] != ASSET_RESIDENT || (needed & ASSET_BIT(i))) continue;
+			if (farthest < 0 || distances[i] > distances[farthest]) farthest = i;
+		}
+
+		if (farthest < 0)
+		{
+			if (!assets->isOverBudget)
+			{
+				TraceLog(LOG_WARNING, "ASSETS: %d KB needed right now, over the %d KB budget",
+					(int)(assets->residentSize / 1024), (int)(assets->budget / 1024));
+			}
+			assets->isOverBudget = true;
+			break;
+		}
+
+		EvictAsset(assets, (enum AssetId)farthest);
+	}
+
+	uint32_t readyMask = assets->readyMask;
+	assets->readyMask = 0;
+	return readyMask;
+}
+
+uint32_t GetResidentAssets(const struct Assets* assets)
+{
+	uint32_t mask = 0;
+	for (int i = 0; i < ASSET_COUNT; i++)
+	{
+		if (assets->status[i] == ASSET_RESIDENT) mask |= ASSET_BIT(i);
+	}
+	return mask;
+}
+
+void WaitForAssets(struct Assets* assets, const enum AssetId* ids, int count)
+{
+	uint32_t mask = 0;
+	for (int i = 0; i < count; i++)
+	{
+		RequestAsset(assets, ids[i]);
+		mask |= ASSET_BIT(ids[i]);
+	}
+
+	for (;;)
+	{
+		UploadDecodedAssets(assets);
+		if ((GetResidentAssets(assets) & mask) == mask) return;
+
+		struct timespec idle = { 0, 1000000 };
+		nanosleep(&idle, NULL);
+	}
+}
+
+void UnloadAssets(struct Assets* assets)
+{
+	for (int i = 0; i < ASSET_COUNT; i++)
+	{
+		if (assets->status[i] == ASSET_DECODING)
+		{
+			while (!__atomic_load_n(&decoded[i].isDecoded, __ATOMIC_ACQUIRE))
+			{
+				struct timespec idle = { 0, 1000000 };
+				nanosleep(&idle, NULL);
+			}
+			UploadAsset(assets, (enum AssetId)i);
+		}
+
+		if (assets->status[i] == ASSET_RESIDENT) EvictAsset(assets, (enum AssetId)i);
+	}
+}
@@ -0,0 +1,83 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "raylib.h"
+
+#include "game.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ASSET_BIT(id) (1u << (id))
+#define ASSET_MUSIC_OVERHEAD (256 * 1024)	// decoder state and stream buffers, estimated
+#define ASSET_WEB_BUDGET (40 * 1024 * 1024)	// the web heap is TOTAL_MEMORY = 64 MB, code and stack included
+
+// Order is load order, the start screen assets go first
+enum AssetId
+{
+	ASSET_SPRITES,
+	ASSET_SDF_SHADER,
+	ASSET_START_PAGE,
+	ASSET_HELP_PAGE,
+	ASSET_FIRE_SHADER,
+	ASSET_FIRE_FLIPBOOK,	// replaces ASSET_FIRE_SHADER in every state with --baked-fire
+	ASSET_CARD_SOUND,
+	ASSET_FIRE_MUSIC,
+	ASSET_BG_MUSIC,
+	ASSET_COUNT
+};
+
+enum AssetStatus
+{
+	ASSET_UNLOADED,
+	ASSET_DECODING,
+	ASSET_RESIDENT,
+};
+
+// Assets are resident per state: whatever the current state and the fade
+// target need is loaded, decoded on a thread and uploaded on the main thread.
+// Whatever no state reachable from the current one needs is unloaded. Over
+// the budget, assets neither state needs go too, the ones needed furthest
+// ahead first, counting from whichever of the two states gets to them sooner.
+struct Assets
+{
+	Texture2D spriteTexture;	// sprites and glyphs, see sprites.h
+	Font mx16Font;
+	Texture2D startPageTexture;
+	Texture2D helpPageTexture;
+	Sound cardSnd;
+	Music fireMusic;
+	Music bgMusic;
+	Shader fireShader;
+	Texture2D fireFlipbook;		// see fire.h
+	Shader sdfShader;
+	bool isFireBaked;
+
+	enum AssetStatus status[ASSET_COUNT];
+	size_t sizes[ASSET_COUNT];	// estimated bytes while resident
+	size_t residentSize;
+	size_t budget;				// 0 is unlimited
+	uint32_t readyMask;			// became resident since the last UpdateAssetLoading
+	bool isOverBudget;
+};
+
+struct AssetConfig
+{
+	size_t budget;
+	bool isFireBaked;			// draw the fire from a flipbook baked at load time instead of fire.fs
+};
+
+// Reads --asset-budget <MB> and --baked-fire, the web build defaults to ASSET_WEB_BUDGET
+struct AssetConfig ParseAssetArgs(int argc, char** argv);
+// Call before GetStateAssets is used from other threads
+void StartLoadingAssets(struct Assets* assets, struct AssetConfig config, enum State state);
+// Main thread, once per frame. next is the fade target, or state when not fading.
+// Returns the assets that became resident since the last call, they need their settings again.
+uint32_t UpdateAssetLoading(struct Assets* assets, enum State state, enum State next);
+uint32_t GetResidentAssets(const struct Assets* assets);
+// Assets state draws with, from any thread after StartLoadingAssets has set isFireBaked
+uint32_t GetStateAssets(enum State state);
+void WaitForAssets(struct Assets* assets, const enum AssetId* ids, int count);
+void UnloadAssets(struct Assets* assets);
+
+#endif
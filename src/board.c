@@ -0,0 +1,216 @@
+#include "board.h"
+
+void InitBoxes(struct Box* boxes, const int* grid, int rows, int cols)
+{
+	for (int i = 0; i < rows; i++)
+	{
+		for (int j = 0; j < cols; j++)
+		{
+			int index = (i * cols) + j;
+			int id = grid[index];
+
+			struct Box box = {
+				.isLeftOpen = (id == 3) || (id == 5) || (id == 7) || (id == 8) || (id == 10) || (id == 11) || (id == 13),
+				.isRightOpen = (id == 1) || (id == 5) || (id == 7) || (id == 8) || (id == 9) || (id == 12) || (id == 14),
+				.isTopOpen = (id == 4) || (id == 6) || (id == 7) || (id == 9) || (id == 10) || (id == 13) || (id == 14),
+				.isBottomOpen = (id == 2) || (id == 6) || (id == 8) || (id == 9) || (id == 10) || (id == 11) || (id == 12),
+				.id = id,
+				.index = index,
+				.x = j,
+				.y = i,
+				.isMain = id == MAIN_PIPE_ID,
+				.isWaterConnected = id == MAIN_PIPE_ID,
+				.rotation = 0,
+				.size = (Vector2){ CELL_SIZE, CELL_SIZE },
+				.direction = RIGHT,
+			};
+
+			boxes[index] = box;
+		}
+	}
+}
+
+
+void RotateBox(struct Box* box)
+{
+	box->rotation += 90.f;
+	if (box->rotation >= 360.f)
+	{
+		box->rotation = 0.f;
+	}
+
+	switch (box->rotation)
+	{
+	case 0:
+		box->direction = RIGHT;
+		break;
+	case 90:
+		box->direction = BOTTOM;
+		break;
+	case 180:
+		box->direction = LEFT;
+		break;
+	case 270:
+		box->direction = TOP;
+		break;
+	default:
+		break;
+	}
+
+	// valve open update
+	bool wasLeftOpen = box->isLeftOpen;
+	bool wasRightOpen = box->isRightOpen;
+	bool wasTopOpen = box->isTopOpen;
+	bool wasBottomOpen = box->isBottomOpen;
+
+	if (box->isLeftOpen) box->isLeftOpen = false;
+	if (box->isRightOpen) box->isRightOpen = false;
+	if (box->isTopOpen) box->isTopOpen = false;
+	if (box->isBottomOpen) box->isBottomOpen = false;
+
+	if (wasLeftOpen) box->isTopOpen = true;
+	if (wasRightOpen) box->isBottomOpen = true;
+	if (wasTopOpen) box->isRightOpen = true;
+	if (wasBottomOpen) box->isLeftOpen = true;
+
+}
+
+
+int GetBoxIndexByPos(struct Box* boxes, int count, Vector2 pos)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (boxes[i].x == pos.x && boxes[i].y == pos.y)
+		{
+			return boxes[i].index;
+		}
+	}
+	return -1;
+}
+
+
+void CheckForAdjacentBox(struct Box* boxes, int rows, int cols, struct Box* box, Vector2 pos, Vector2* visited)
+{
+	int count = rows * cols;
+
+	// check if already visited
+	for (int i = 0; i < count; i++)
+	{
+		if (visited[i].x == pos.x && visited[i].y == pos.y)
+		{
+			return;
+		}
+	}
+
+	visited[box->index] = pos;
+
+	// top
+	if (pos.y > 0)
+	{
+		Vector2 newBoxPos = (Vector2){ pos.x, pos.y - 1 };
+		int newBoxIndex = GetBoxIndexByPos(boxes, count, newBoxPos);
+
+		if (box->isTopOpen && boxes[newBoxIndex].isBottomOpen)
+		{
+			box->isWaterConnected = true;
+			boxes[newBoxIndex].isWaterConnected = true;
+			CheckForAdjacentBox(boxes, rows, cols, &boxes[newBoxIndex], newBoxPos, visited);
+		}
+
+	}
+
+	// right
+	if (pos.x < cols - 1)
+	{
+		Vector2 newBoxPos = (Vector2){ pos.x + 1, pos.y };
+		int newBoxIndex = GetBoxIndexByPos(boxes, count, newBoxPos);
+
+		if (box->isRightOpen && boxes[newBoxIndex].isLeftOpen)
+		{
+			box->isWaterConnected = true;
+			boxes[newBoxIndex].isWaterConnected = true;
+			CheckForAdjacentBox(boxes, rows, cols, &boxes[newBoxIndex], newBoxPos, visited);
+		}
+
+	}
+
+	// bottom
+	if (pos.y < rows - 1)
+	{
+		Vector2 newBoxPos = (Vector2){ pos.x, pos.y + 1 };
+		int newBoxIndex = GetBoxIndexByPos(boxes, count, newBoxPos);
+
+		if (box->isBottomOpen && boxes[newBoxIndex].isTopOpen)
+		{
+			box->isWaterConnected = true;
+			boxes[newBoxIndex].isWaterConnected = true;
+			CheckForAdjacentBox(boxes, rows, cols, &boxes[newBoxIndex], newBoxPos, visited);
+		}
+
+	}
+
+	// left
+	if (pos.x > 0)
+	{
+		Vector2 newBoxPos = (Vector2){ pos.x - 1, pos.y, };
+		int newBoxIndex = GetBoxIndexByPos(boxes, count, newBoxPos);
+
+		if (box->isLeftOpen && boxes[newBoxIndex].isRightOpen)
+		{
+			box->isWaterConnected = true;
+			boxes[newBoxIndex].isWaterConnected = true;
+			CheckForAdjacentBox(boxes, rows, cols, &boxes[newBoxIndex], newBoxPos, visited);
+		}
+
+	}
+
+}
+
+
+// Per frame water update, visited needs room for rows * cols entries.
+// Returns true when every box is connected to the water.
+bool UpdateWater(struct Box* boxes, int rows, int cols, Vector2* visited)
+{
+	int count = rows * cols;
+
+	// Set visited to -1
+	for (int i = 0; i < count; i++)
+	{
+		visited[i] = (Vector2){ -1, -1 };
+	}
+
+	// Set all water connection to false
+	for (int i = 0; i < count; i++)
+	{
+		if (!boxes[i].isMain)
+		{
+			boxes[i].isWaterConnected = false;
+		}
+	}
+
+	// Update water present in the pipes
+	for (int i = 0; i < cols; i++)
+	{
+		for (int j = 0; j < rows; j++)
+		{
+			int index = GetBoxIndexByPos(boxes, count, (Vector2) { i, j });
+			if (boxes[index].isMain)
+			{
+				CheckForAdjacentBox(boxes, rows, cols, &boxes[index], (Vector2) { i, j }, visited);
+				break;
+			}
+		}
+	}
+
+	// Validate answer
+	bool isCorrect = true;
+	for (int i = 0; i < count; i++)
+	{
+		if (!boxes[i].isWaterConnected)
+		{
+			isCorrect = false;
+		}
+	}
+
+	return isCorrect;
+}
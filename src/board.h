@@ -0,0 +1,49 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "raylib.h"
+
+#define CELL_SIZE 16.f
+#define MAIN_PIPE_ID 8
+
+enum Direction
+{
+	TOP,
+	LEFT,
+	RIGHT,
+	BOTTOM
+};
+
+struct Box
+{
+	int id;
+	int index;
+	float x;
+	float y;
+	bool isMain;
+	bool isWaterConnected;
+	int rotation;
+
+	bool isLeftOpen;
+	bool isTopOpen;
+	bool isRightOpen;
+	bool isBottomOpen;
+
+	Vector2 gridPos;
+	Vector2 size;
+	Rectangle source;
+	Rectangle dest;
+	Vector2 origin;
+
+	enum Direction direction;
+
+};
+
+// Boards are rows * cols boxes, row major. grid holds the pipe ids in the same order.
+void InitBoxes(struct Box* boxes, const int* grid, int rows, int cols);
+void RotateBox(struct Box* box);
+int GetBoxIndexByPos(struct Box* boxes, int count, Vector2 pos);
+void CheckForAdjacentBox(struct Box* boxes, int rows, int cols, struct Box* box, Vector2 pos, Vector2* visited);
+bool UpdateWater(struct Box* boxes, int rows, int cols, Vector2* visited);
+
+#endif
@@ -0,0 +1,298 @@
+#include "boardset.h"
+#include "cores.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(PLATFORM_WEB)
+#include <pthread.h>
+#endif
+
+// The set is fixed by StartBoardSet, the frame delta is written before a step is published
+static struct BoardSet* steppedSet;
+static float steppedDt;
+// Next board to hand out and boards finished in the current step
+static int nextBoard;
+static int finishedBoards;
+
+#if !defined(PLATFORM_WEB)
+static pthread_t workers[BOARD_SET_MAX_WORKERS];
+static int workerCount = 0;
+// Only for waking the workers and the stepping thread, boards are handed out lock free
+static pthread_mutex_t poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stepCond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t doneCond = PTHREAD_COND_INITIALIZER;
+static uint32_t stepGeneration = 0;
+static bool shouldStop = false;
+#endif
+
+static uint32_t NextRandom(uint32_t* seed)
+{
+	// xorshift32
+	uint32_t x = *seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*seed = x;
+	return x;
+}
+
+// Most cells connected after up to depth more quarter turns of any cells
+static int GetBestWaterCount(const struct ValidatorPuzzle* puzzle, uint8_t* rotations, int depth)
+{
+	int bestCount = __builtin_popcountll(GetWaterMask(puzzle, rotations));
+	if (depth == 0) return bestCount;
+
+	for (int cell = 0; cell < puzzle->count; cell++)
+	{
+		uint8_t rotation = rotations[cell];
+		for (int turns = 1; turns < 4; turns++)
+		{
+			rotations[cell] = (rotation + turns) & 3;
+			int count = GetBestWaterCount(puzzle, rotations, depth - 1);
+			if (count > bestCount) bestCount = count;
+		}
+		rotations[cell] = rotation;
+	}
+
+	return bestCount;
+}
+
+// Picks the cell and quarter turns that connect the most cells, counting the
+// best follow up turns too (SOLVER_LOOKAHEAD), so a pipe can be turned away for
+// a moment to let the water around a corner. Ties are broken at random. When nothing improves
+// the water, or once in SOLVER_MISTAKE_ODDS, turns a random cell instead.
+static void PlanMove(const struct ValidatorPuzzle* puzzle, struct SetBoard* board)
+{
+	int bestCell = -1;
+	int bestTurns = 0;
+	int bestCount = __builtin_popcountll(board->water);
+	int tieCount = 0;
+
+	if (NextRandom(&board->seed) % SOLVER_MISTAKE_ODDS != 0)
+	{
+		for (int cell = 0; cell < puzzle->count; cell++)
+		{
+			uint8_t rotation = board->rotations[cell];
+			for (int turns = 1; turns < 4; turns++)
+			{
+				board->rotations[cell] = (rotation + turns) & 3;
+				int count = GetBestWaterCount(puzzle, board->rotations, SOLVER_LOOKAHEAD - 1);
+
+				if (count > bestCount)
+				{
+					bestCell = cell;
+					bestTurns = turns;
+					bestCount = count;
+					tieCount = 1;
+				}
+				else if (count == bestCount && bestCell >= 0 && NextRandom(&board->seed) % ++tieCount == 0)
+				{
+					bestCell = cell;
+					bestTurns = turns;
+				}
+			}
+			board->rotations[cell] = rotation;
+		}
+	}
+
+	if (bestCell < 0)
+	{
+		bestCell = NextRandom(&board->seed) % puzzle->count;
+		bestTurns = 1 + NextRandom(&board->seed) % 3;
+	}
+
+	board->targetCell = bestCell;
+	board->targetTurns = bestTurns;
+}
+
+// One quarter turn per think interval, like a player clicking
+static void StepBoard(const struct ValidatorPuzzle* puzzle, struct SetBoard* board, float dt)
+{
+	if (board->isCorrect || board->isLost) return;
+
+	board->timeLeft -= dt;
+	if (board->timeLeft <= 0.f)
+	{
+		board->timeLeft = 0.f;
+		board->isLost = true;
+		return;
+	}
+
+	board->thinkTime -= dt;
+	while (board->thinkTime <= 0.f && !board->isCorrect)
+	{
+		board->thinkTime += board->thinkInterval;
+
+		if (board->targetTurns == 0) PlanMove(puzzle, board);
+		if (board->targetTurns == 0) break;
+
+		board->rotations[board->targetCell] = (board->rotations[board->targetCell] + 1) & 3;
+		board->targetTurns -= 1;
+
+		board->water = GetWaterMask(puzzle, board->rotations);
+		board->isCorrect = board->water == puzzle->all;
+	}
+}
+
+// Steps boards until none are left to hand out, returns how many this thread stepped.
+// steppedDt is only read for a board of the current step, a worker that found
+// nothing left in the last one may still get here while the next is being set up.
+static int StepClaimedBoards(void)
+{
+	struct BoardSet* set = steppedSet;
+	int stepped = 0;
+
+	for (;;)
+	{
+		int index = __atomic_fetch_add(&nextBoard, 1, __ATOMIC_ACQ_REL);
+		if (index >= set->count) break;
+
+		StepBoard(&set->puzzle, &set->boards[index], steppedDt);
+		stepped += 1;
+	}
+
+	return stepped;
+}
+
+#if !defined(PLATFORM_WEB)
+static void* WorkerLoop(void* arg)
+{
+	(void)arg;
+	uint32_t seenGeneration = 0;
+
+	while (true)
+	{
+		pthread_mutex_lock(&poolMutex);
+		while (stepGeneration == seenGeneration && !shouldStop)
+		{
+			pthread_cond_wait(&stepCond, &poolMutex);
+		}
+		bool isStopping = shouldStop;
+		seenGeneration = stepGeneration;
+		pthread_mutex_unlock(&poolMutex);
+
+		if (isStopping) break;
+
+		int stepped = StepClaimedBoards();
+		if (stepped > 0 && __atomic_add_fetch(&finishedBoards, stepped, __ATOMIC_ACQ_REL) == steppedSet->count)
+		{
+			pthread_mutex_lock(&poolMutex);
+			pthread_cond_signal(&doneCond);
+			pthread_mutex_unlock(&poolMutex);
+		}
+	}
+
+	return NULL;
+}
+#endif
+
+struct BoardSetConfig ParseBoardSetArgs(int argc, char** argv)
+{
+	struct BoardSetConfig config = { 0 };
+
+#if !defined(PLATFORM_WEB)
+	config.workerCount = GetCoreCount() - 2;
+#endif
+
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], "--boards") == 0) config.boardCount = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--board-workers") == 0) config.workerCount = atoi(argv[i + 1]);
+	}
+
+	if (config.boardCount < 0) config.boardCount = 0;
+	if (config.boardCount > BOARD_SET_MAX) config.boardCount = BOARD_SET_MAX;
+	if (config.workerCount < 0) config.workerCount = 0;
+	if (config.workerCount > BOARD_SET_MAX_WORKERS) config.workerCount = BOARD_SET_MAX_WORKERS;
+	// No point in more workers than boards, the caller steps one too
+	if (config.workerCount > config.boardCount - 1) config.workerCount = config.boardCount > 0 ? config.boardCount - 1 : 0;
+
+	return config;
+}
+
+void StartBoardSet(struct BoardSet* set, struct BoardSetConfig config)
+{
+	set->count = config.boardCount;
+	steppedSet = set;
+
+#if !defined(PLATFORM_WEB)
+	// Without workers StepBoardSet steps every board itself, like the web build
+	shouldStop = false;
+	stepGeneration = 0;
+	for (workerCount = 0; workerCount < config.workerCount; workerCount++)
+	{
+		if (pthread_create(&workers[workerCount], NULL, WorkerLoop, NULL) != 0) break;
+	}
+#endif
+}
+
+void StopBoardSet(void)
+{
+#if !defined(PLATFORM_WEB)
+	pthread_mutex_lock(&poolMutex);
+	shouldStop = true;
+	pthread_cond_broadcast(&stepCond);
+	pthread_mutex_unlock(&poolMutex);
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+	workerCount = 0;
+#endif
+}
+
+void ResetBoardSet(struct BoardSet* set, const int* grid, float levelTime)
+{
+	memcpy(set->grid, grid, sizeof set->grid);
+	set->levelTime = levelTime;
+	InitValidatorPuzzle(&set->puzzle, grid, PUZZLE_ROWS, PUZZLE_COLS);
+
+	for (int i = 0; i < set->count; i++)
+	{
+		struct SetBoard* board = &set->boards[i];
+		*board = (struct SetBoard){
+			.timeLeft = levelTime,
+			.targetCell = -1,
+			.seed = (uint32_t)rand() | 1,
+		};
+
+		// Solvers between 0.75 and 1.25 times SOLVER_THINK_TIME
+		board->thinkInterval = SOLVER_THINK_TIME * (0.75f + 0.5f * (NextRandom(&board->seed) % 1024) / 1024.f);
+		board->thinkTime = board->thinkInterval;
+		board->water = GetWaterMask(&set->puzzle, board->rotations);
+	}
+}
+
+void StepBoardSet(struct BoardSet* set, float dt)
+{
+	if (set->count == 0) return;
+
+	steppedDt = dt;
+	__atomic_store_n(&finishedBoards, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&nextBoard, 0, __ATOMIC_RELEASE);
+
+#if !defined(PLATFORM_WEB)
+	if (workerCount > 0)
+	{
+		pthread_mutex_lock(&poolMutex);
+		stepGeneration += 1;
+		pthread_cond_broadcast(&stepCond);
+		pthread_mutex_unlock(&poolMutex);
+
+		int stepped = StepClaimedBoards();
+		__atomic_add_fetch(&finishedBoards, stepped, __ATOMIC_ACQ_REL);
+
+		pthread_mutex_lock(&poolMutex);
+		while (__atomic_load_n(&finishedBoards, __ATOMIC_ACQUIRE) < set->count)
+		{
+			pthread_cond_wait(&doneCond, &poolMutex);
+		}
+		pthread_mutex_unlock(&poolMutex);
+		return;
+	}
+#endif
+
+	StepClaimedBoards();
+}
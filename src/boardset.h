@@ -0,0 +1,60 @@
+#ifndef BOARDSET_H
+#define BOARDSET_H
+
+#include "puzzles.h"
+#include "validator.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOARD_SET_MAX 48			// 3 rows of 16 tiles below the board, see game.h
+#define BOARD_SET_MAX_WORKERS 8
+#define BOARD_SET_CELLS (PUZZLE_ROWS * PUZZLE_COLS)
+#define SOLVER_THINK_TIME 0.25f	// average seconds between two quarter turns of a solver
+#define SOLVER_MISTAKE_ODDS 5		// one move in this many is random, so solvers can be beaten and don't get stuck
+#define SOLVER_LOOKAHEAD 2			// cells turned in a solver plan, each one more costs 3 * cells times the last
+
+// One opponent board: its own rotations, water and timer, played by a solver
+struct SetBoard
+{
+	uint8_t rotations[BOARD_SET_CELLS];	// quarter turns per cell, row major
+	uint64_t water;						// cells connected to the water, see GetWaterMask
+	float timeLeft;						// in seconds
+	float thinkTime;					// until the next quarter turn
+	float thinkInterval;
+	int targetCell;						// cell the solver is turning, -1 when it needs a new plan
+	int targetTurns;					// quarter turns left on targetCell
+	uint32_t seed;						// per board random state, the workers don't share rand()
+	bool isCorrect;
+	bool isLost;
+};
+
+// Boards all playing the same puzzle at once. Boards are independent, so
+// StepBoardSet hands them out one at a time to a worker pool and the calling
+// thread, and returns once every board is stepped. The connectivity and win
+// checks run on the validator bitboards instead of struct Box.
+struct BoardSet
+{
+	struct SetBoard boards[BOARD_SET_MAX];
+	int count;
+	int grid[BOARD_SET_CELLS];			// pipe ids, row major
+	float levelTime;
+	struct ValidatorPuzzle puzzle;
+};
+
+struct BoardSetConfig
+{
+	int boardCount;
+	int workerCount;					// threads besides the caller of StepBoardSet
+};
+
+// Reads --boards <count> and --board-workers <count>, workers default to the cores
+// left over by the render and simulation threads
+struct BoardSetConfig ParseBoardSetArgs(int argc, char** argv);
+void StartBoardSet(struct BoardSet* set, struct BoardSetConfig config);
+void StopBoardSet(void);
+// grid is rows * cols pipe ids, every board starts over on it with levelTime to go
+void ResetBoardSet(struct BoardSet* set, const int* grid, float levelTime);
+void StepBoardSet(struct BoardSet* set, float dt);
+
+#endif
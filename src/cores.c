@@ -0,0 +1,24 @@
+#include "cores.h"
+
+// windows.h clashes with raylib.h, which is why this lives on its own
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(PLATFORM_WEB)
+#include <unistd.h>
+#endif
+
+int GetCoreCount(void)
+{
+	int count = 1;
+
+#if defined(_WIN32)
+	// mingw-w64 has no sysconf
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	count = (int)info.dwNumberOfProcessors;
+#elif !defined(PLATFORM_WEB)
+	count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	return count > 0 ? count : 1;
+}
@@ -0,0 +1,7 @@
+#ifndef CORES_H
+#define CORES_H
+
+// Online logical processors, at least 1. No raylib, the command line tools use it too.
+int GetCoreCount(void);
+
+#endif
@@ -0,0 +1,72 @@
+#include "fire.h"
+
+#include <math.h>
+
+#define FIRE_FLIPBOOK_ROWS (FIRE_FLIPBOOK_FRAMES / FIRE_FLIPBOOK_COLUMNS)
+
+// Runs on the asset decoding thread, touches no GL state
+Image GenFireFlipbook(Image noise)
+{
+	int width = noise.width;
+	int height = noise.height;
+	int frameHeight = height * 2;
+	int atlasWidth = width * FIRE_FLIPBOOK_COLUMNS;
+
+	Image flipbook = {
+		.data = RL_CALLOC(atlasWidth * frameHeight * FIRE_FLIPBOOK_ROWS, 2),
+		.width = atlasWidth,
+		.height = frameHeight * FIRE_FLIPBOOK_ROWS,
+		.mipmaps = 1,
+		.format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA,
+	};
+
+	Color* pixels = LoadImageColors(noise);
+	unsigned char* data = flipbook.data;
+
+	for (int frame = 0; frame < FIRE_FLIPBOOK_FRAMES; frame++)
+	{
+		int scroll = frame * height / FIRE_FLIPBOOK_FRAMES;
+		int frameX = (frame % FIRE_FLIPBOOK_COLUMNS) * width;
+		int frameY = (frame / FIRE_FLIPBOOK_COLUMNS) * frameHeight;
+
+		// Frame row 0 is one noise height above the top of the screen
+		for (int row = 0; row < frameHeight; row++)
+		{
+			int screenRow = row - height;
+			int noiseRow = ((screenRow + scroll) % height + height) % height;
+			float y = (screenRow + 0.5f) / height;
+
+			unsigned char* out = &data[((frameY + row) * atlasWidth + frameX) * 2];
+			for (int x = 0; x < width; x++)
+			{
+				// Same test as fire.fs with a yOffset of 0, in the red channel
+				bool isBurning = pixels[noiseRow * width + x].r / 255.f + y > FIRE_THRESHOLD;
+				out[x * 2] = 255;
+				out[x * 2 + 1] = isBurning ? 255 : 0;
+			}
+		}
+	}
+
+	UnloadImageColors(pixels);
+	return flipbook;
+}
+
+Rectangle GetFireFlipbookRect(Texture2D flipbook, float time, float yOffset)
+{
+	int width = flipbook.width / FIRE_FLIPBOOK_COLUMNS;
+	int frameHeight = flipbook.height / FIRE_FLIPBOOK_ROWS;
+	int height = frameHeight / 2;
+
+	// Rows the flame moved down and rows the noise scrolled, fire.fs samples
+	// the noise row nearest to the pixel center
+	int shift = (int)roundf(fminf(fmaxf(yOffset, 0.f), 1.f) * height);
+	int scroll = (int)floorf(0.5f + height * fmodf(time * FIRE_ANIMATION_SPEED, 1.f));
+	int frame = (shift + scroll) % height * FIRE_FLIPBOOK_FRAMES / height;
+
+	return (Rectangle){
+		(float)((frame % FIRE_FLIPBOOK_COLUMNS) * width),
+		(float)((frame / FIRE_FLIPBOOK_COLUMNS) * frameHeight + height - shift),
+		(float)width,
+		(float)height
+	};
+}
@@ -0,0 +1,24 @@
+#ifndef FIRE_H
+#define FIRE_H
+
+#include "raylib.h"
+
+#define FIRE_ANIMATION_SPEED 0.5f	// noise scrolls (heights per second), the animationSpeed uniform of fire.fs
+#define FIRE_THRESHOLD 0.3f			// noise plus height above this burns, the step in fire.fs
+#define FIRE_FLIPBOOK_FRAMES 64		// scroll positions baked, must divide the noise height
+#define FIRE_FLIPBOOK_COLUMNS 16
+
+// The flame of fire.fs baked into a flipbook, for GPUs where the per pixel
+// pass is the most expensive part of the frame. A frame only depends on
+// where the noise has scrolled to. yOffset moves the flame down and scrolls
+// the noise by the same amount, so it is drawn as a vertical shift into a frame
+// twice the noise height instead of being baked too.
+//
+// Frames are white where fire.fs burns in the red channel and transparent
+// elsewhere, drawn tinted with the flame color. GLES2 has no texture arrays,
+// the frames are laid out in one texture, FIRE_FLIPBOOK_COLUMNS to a row.
+Image GenFireFlipbook(Image noise);
+// Source rect of the flame at time and yOffset (0 to 1), same size as the noise
+Rectangle GetFireFlipbookRect(Texture2D flipbook, float time, float yOffset);
+
+#endif
@@ -0,0 +1,498 @@
+#include "game.h"
+
+#include "raymath.h"
+
+#include "assets.h"
+#include "sprites.h"
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static Vector2 GetFontOrigin(struct Text textData)
+{
+	return (Vector2){textData.size.x/2.f, textData.size.y/2.f};
+}
+
+static Vector2 GetFontSize(Font font, struct Text textData)
+{
+	return MeasureTextEx(font, textData.text, textData.fontSize, textData.spacing);
+}
+
+static void ResetFadeTransition(struct Transition* fade, bool isFadeOut)
+{
+
+	fade->isCompleted = false;
+
+	if (isFadeOut) {
+		fade->size = (Vector2){WINDOW_WIDTH, WINDOW_HEIGHT};
+		fade->isStarted = true;
+	} else {
+		fade->isStarted = false;
+		fade->size = (Vector2){WINDOW_WIDTH, 0};
+	}
+}
+
+static void RestartLevel(struct Game* game)
+{
+	InitBoxes(game->boxes, &game->puzzles[game->currentPuzzleIndex].puzzleGrid[0][0], ROWS, COLS);
+	ResetHistory(&game->history, game->boxes, BOX_COUNT);
+	game->historyWheel = 0.f;
+	game->currentLevelTime = game->puzzles[game->currentPuzzleIndex].levelTime;
+	game->fireYoffset = 1.f;
+}
+
+static void BobText(struct Text* text, float dt)
+{
+	text->pos.y += text->speed * dt;
+	if (text->pos.y > text->startPos.y + 30.f || text->pos.y < text->startPos.y) {
+		text->speed *= -1;
+	}
+}
+
+void InitGame(struct Game* game, Font font)
+{
+	Color whiteColor = GetColor(0xffffffff);
+	Color greenColor = GetColor(0x45e082ff);
+
+	*game = (struct Game){
+		.state = START,
+		.font = font,
+		.player = { .pos = (Vector2){ (float)START_POS, (float)START_POS } },
+		.cameraTarget = (Vector2){WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f},
+		.shakeIntensity = 4.0f,
+		.fireYoffset = 1.f,
+	};
+
+	for (int i = 0; i < TOTAL_PUZZLES; i++)
+	{
+		game->puzzles[i] = (struct Puzzle){
+			.levelTime = puzzleData[i].levelTime,
+			.isCorrect = false,
+		};
+		memcpy(game->puzzles[i].puzzleGrid, puzzleData[i].grid, sizeof(game->puzzles[i].puzzleGrid));
+	}
+
+	InitBoxes(game->boxes, &game->puzzles[game->currentPuzzleIndex].puzzleGrid[0][0], ROWS, COLS);
+	ResetHistory(&game->history, game->boxes, BOX_COUNT);
+	game->currentLevelTime = game->puzzles[game->currentPuzzleIndex].levelTime;
+
+	// Set all texts
+	struct Text* playText = &game->texts[TEXT_PLAY];
+	*playText = (struct Text){
+		.text = "'Left Click' to play",
+		.fontSize = 32.f,
+		.spacing = 1.f,
+		.color = whiteColor,
+		.speed = 20,
+	};
+	playText->size = GetFontSize(font, *playText);
+	playText->origin = GetFontOrigin(*playText);
+	playText->pos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT - 200.f};
+	playText->startPos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT - 200.f};
+
+	struct Text* levelText = &game->texts[TEXT_LEVEL];
+	*levelText = (struct Text){
+		.text = "Level: 1",
+		.fontSize = 32.f,
+		.spacing = 1.f,
+		.color = whiteColor,
+	};
+	levelText->size = GetFontSize(font, *levelText);
+	levelText->origin = (Vector2){0.f, 0.f};
+	levelText->pos = (Vector2){10.f, 10.f};
+
+	struct Text* timeText = &game->texts[TEXT_TIME];
+	*timeText = (struct Text){
+		.text = "Time: 1.0000",
+		.fontSize = 32.f,
+		.spacing = 1.f,
+		.color = whiteColor,
+	};
+	timeText->size = GetFontSize(font, *timeText);
+	timeText->origin = (Vector2){0.f, 0.f};
+	timeText->pos = (Vector2){10.f, levelText->pos.y + levelText->size.y + 10.f};
+
+	struct Text* burnedText = &game->texts[TEXT_BURNED];
+	*burnedText = (struct Text){
+		.text = "BURNNNN'd",
+		.fontSize = 64.f,
+		.spacing = 2.f,
+		.color = whiteColor,
+	};
+	burnedText->size = GetFontSize(font, *burnedText);
+	burnedText->origin = GetFontOrigin(*burnedText);
+	burnedText->pos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT/4.f};
+
+	struct Text* restartText = &game->texts[TEXT_RESTART];
+	*restartText = (struct Text){
+		.text = "'Left Click' to restart",
+		.fontSize = 32.f,
+		.spacing = 1.f,
+		.color = whiteColor,
+	};
+	restartText->size = GetFontSize(font, *restartText);
+	restartText->origin = GetFontOrigin(*restartText);
+	restartText->pos = (Vector2){WINDOW_WIDTH/2.f, burnedText->pos.y + burnedText->size.y + 10.f};
+
+	struct Text* wonText = &game->texts[TEXT_WON];
+	*wonText = (struct Text){
+		.text = "Doused!",
+		.fontSize = 64.f,
+		.spacing = 2.f,
+		.color = greenColor,
+	};
+	wonText->size = GetFontSize(font, *wonText);
+	wonText->origin = GetFontOrigin(*wonText);
+	wonText->pos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT/8.f};
+
+	struct Text* nextText = &game->texts[TEXT_NEXT];
+	*nextText = (struct Text){
+		.text = "'Left Click' for next level",
+		.fontSize = 32.f,
+		.spacing = 1.f,
+		.color = whiteColor,
+	};
+	nextText->size = GetFontSize(font, *nextText);
+	nextText->origin = GetFontOrigin(*nextText);
+	nextText->pos = (Vector2){WINDOW_WIDTH/2.f, wonText->pos.y + wonText->size.y + 10.f};
+
+	struct Text* endText = &game->texts[TEXT_END];
+	*endText = (struct Text){
+		.text = "Thank you for playing my game!",
+		.fontSize = 48.f,
+		.spacing = 2.f,
+		.color = whiteColor,
+	};
+	endText->size = GetFontSize(font, *endText);
+	endText->origin = GetFontOrigin(*endText);
+	endText->pos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT/6.f};
+
+	game->fadeOut = (struct Transition){
+		.pos = (Vector2){0, 0},
+		.size = (Vector2){WINDOW_WIDTH, WINDOW_HEIGHT},
+		.isCompleted = false,
+		.isStarted = true,
+		.speed = 20
+	};
+	game->fadeIn = (struct Transition){
+		.pos = (Vector2){0, 0},
+		.size = (Vector2){WINDOW_WIDTH, 0},
+		.isCompleted = false,
+		.isStarted = false,
+		.speed = 20
+	};
+}
+
+void UnloadGame(struct Game* game)
+{
+	UnloadHistory(&game->history);
+}
+
+void StepGame(struct Game* game, const struct FrameInput* input)
+{
+	struct Puzzle* puzzles = game->puzzles;
+	struct Box* boxes = game->boxes;
+	struct Transition* fadeIn = &game->fadeIn;
+	struct Transition* fadeOut = &game->fadeOut;
+	float dt = input->dt;
+
+	game->inputSequence = input->sequence;
+	game->residentAssets = input->residentAssets;
+
+	// Common state
+	game->fireTime += dt;
+
+	if (dt > FRAME_SPIKE_TIME)
+	{
+		TelemetryRecord(TELEMETRY_FRAME_SPIKE, game->currentPuzzleIndex, game->state, 0, dt * 1000.f);
+	}
+
+	if (game->shouldCameraShake)
+	{
+		game->shakeDuration = 0.05f;
+		game->shakeIntensity = 1.f;
+	}
+
+	if (game->shakeDuration > 0.0f)
+	{
+		float offsetX = GetRandomValue(-game->shakeIntensity, game->shakeIntensity);
+		float offsetY = GetRandomValue(-game->shakeIntensity, game->shakeIntensity);
+
+		// Apply shake effect to camera target
+		game->cameraTarget.x += offsetX;
+		game->cameraTarget.y += offsetY;
+
+		game->shakeDuration -= dt;
+		game->shouldCameraShake = false;
+	}
+	else
+	{
+		game->cameraTarget = Vector2MoveTowards(game->cameraTarget, (Vector2){WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f}, 200 * dt);
+	}
+
+	if (fadeOut->isStarted && !fadeOut->isCompleted) {
+		fadeOut->size = Vector2MoveTowards(fadeOut->size, (Vector2){fadeOut->size.x, 0.f}, fadeOut->speed);
+		if (fadeOut->size.y <= 0) {
+			fadeOut->isCompleted = true;
+		}
+	}  else if (fadeIn->isStarted && !fadeIn->isCompleted) {
+
+		fadeIn->size = Vector2MoveTowards(fadeIn->size, (Vector2){fadeIn->size.x, WINDOW_HEIGHT}, fadeIn->speed);
+		// The screen stays black until the next state's assets are resident
+		bool isNextLoaded = (GetStateAssets(fadeIn->to) & ~input->residentAssets) == 0;
+		if (fadeIn->size.y >= WINDOW_HEIGHT && isNextLoaded) {
+			fadeIn->isCompleted = true;
+			TelemetryRecord(TELEMETRY_STATE_CHANGE, game->currentPuzzleIndex, game->state, fadeIn->to, game->currentLevelTime);
+			game->state = fadeIn->to;
+			ResetFadeTransition(fadeOut, true);
+
+			// The opponents start together with the player
+			if (game->state == PLAYING)
+			{
+				struct Puzzle* puzzle = &puzzles[game->currentPuzzleIndex];
+				ResetBoardSet(&game->opponents, &puzzle->puzzleGrid[0][0], puzzle->levelTime);
+			}
+			ResetFadeTransition(fadeIn, false);
+		}
+	}
+
+	struct Puzzle* puzzle = &puzzles[game->currentPuzzleIndex];
+
+	switch (game->state)
+	{
+	case START:
+		if (fadeOut->isCompleted && !fadeIn->isStarted) {
+			BobText(&game->texts[TEXT_PLAY], dt);
+			if (input->isClick)
+			{
+				game->currentLevelTime = puzzle->levelTime;
+				fadeIn->to = HOWTO;
+				fadeIn->isStarted = true;
+			}
+		}
+		break;
+	case HOWTO:
+		if (fadeOut->isCompleted && !fadeIn->isStarted) {
+			BobText(&game->texts[TEXT_PLAY], dt);
+			if (input->isClick)
+			{
+				game->currentLevelTime = puzzle->levelTime;
+				fadeIn->to = PLAYING;
+				fadeIn->isStarted = true;
+			}
+		}
+		break;
+	case PLAYING:
+		game->currentLevelTime -= dt;
+		if (game->currentLevelTime < 0 ){
+			game->currentLevelTime = 0;
+		}
+		if (fadeOut->isCompleted && !fadeIn->isStarted) {
+			if (!puzzle->isCorrect && !puzzle->isLost)
+			{
+
+				game->fireYoffset = 1.f * (game->currentLevelTime / puzzle->levelTime);
+
+				if (game->fireYoffset <= 0.0f || game->currentLevelTime <= 0.f)
+				{
+					fadeIn->to = LOST;
+					fadeIn->isStarted = true;
+				}
+			}
+
+			// Update mouse + player movement
+			Vector2 gridPosition = (Vector2){ floorf(input->mousePos.x / (CELL_SIZE * SCALE_FACTOR)),
+					floorf(input->mousePos.y / (CELL_SIZE * SCALE_FACTOR)) };
+
+			gridPosition.x = Clamp(gridPosition.x, SPACING, TOTAL_COUNT - SPACING - 1);
+			gridPosition.y = Clamp(gridPosition.y, SPACING, TOTAL_COUNT - SPACING - 1);
+
+			game->player.pos.x = gridPosition.x * CELL_SIZE;
+			game->player.pos.y = gridPosition.y * CELL_SIZE;
+
+			// Update box
+			for (int i = 0; i < ROWS; i++)
+			{
+				for (int j = 0; j < ROWS; j++)
+				{
+					int index = GetBoxIndexByPos(boxes, BOX_COUNT, (Vector2) { i, j });
+
+					boxes[index].dest = (Rectangle){
+						((i + SPACING) * CELL_SIZE) + (CELL_SIZE / 2.f), ((j + SPACING) * CELL_SIZE) + (CELL_SIZE / 2.f),
+						CELL_SIZE,
+						CELL_SIZE
+					};
+
+					boxes[index].origin = (Vector2){ boxes[index].dest.width / 2.f, boxes[index].dest.height / 2.f };
+
+					if (boxes[index].x == gridPosition.x - 2 && boxes[index].y == gridPosition.y - 2 && input->isClick
+						&& !puzzle->isCorrect && !puzzle->isLost)
+					{
+						RotateBox(&boxes[index]);
+						RecordRotation(&game->history, boxes, index, 1);
+						game->submittedClickTime = input->clickTime;
+						TelemetryRecord(TELEMETRY_ROTATE_BOX, game->currentPuzzleIndex, index, boxes[index].rotation / 90, game->currentLevelTime);
+						game->shouldCameraShake = true;
+						game->soundCount += 1;
+
+						game->wrenchRotation += 90.f;
+					}
+				}
+			}
+
+			// Undo (Z), redo (Y) and scrub the rotation history with the mouse wheel
+			if (!puzzle->isCorrect && !puzzle->isLost)
+			{
+				int historyCursor = game->history.cursor;
+				game->historyWheel += input->wheelMove;
+				int wheelMove = (int)game->historyWheel;
+				game->historyWheel -= (float)wheelMove;
+
+				if (input->isUndo) UndoRotation(&game->history, boxes);
+				if (input->isRedo) RedoRotation(&game->history, boxes);
+				if (wheelMove != 0) SeekHistory(&game->history, boxes, game->history.cursor + wheelMove);
+
+				if (game->history.cursor != historyCursor)
+				{
+					game->soundCount += 1;
+				}
+			}
+
+			struct Text* levelText = &game->texts[TEXT_LEVEL];
+			struct Text* timeText = &game->texts[TEXT_TIME];
+			snprintf(levelText->text, sizeof levelText->text, "Level: %d", game->currentPuzzleIndex + 1);
+			snprintf(timeText->text, sizeof timeText->text, "Time: %1.1f", game->currentLevelTime);
+			levelText->size = GetFontSize(game->font, *levelText);
+			timeText->size = GetFontSize(game->font, *timeText);
+
+			// Opponents play until the player is done
+			StepBoardSet(&game->opponents, dt);
+
+			// Update water present in the pipes and validate answer
+			Vector2 visited[BOX_COUNT];
+			puzzle->isCorrect = UpdateWater(boxes, ROWS, COLS, visited);
+
+			if (puzzle->isCorrect)
+			{
+				game->currentPuzzleIndex += 1;
+				if (game->currentPuzzleIndex < TOTAL_PUZZLES)
+				{
+					fadeIn->isStarted = true;
+					fadeIn->to = WON;
+				}
+				else
+				{
+					fadeIn->isStarted = true;
+					fadeIn->to = END;
+				}
+			}
+		}
+
+		break;
+	case END:
+		break;
+	case WON:
+		if (fadeOut->isCompleted && !fadeIn->isStarted) {
+			if (input->isClick)
+			{
+				RestartLevel(game);
+				fadeIn->to = PLAYING;
+				fadeIn->isStarted = true;
+			}
+		}
+
+		break;
+	case LOST:
+		if (fadeOut->isCompleted && !fadeIn->isStarted) {
+			if (input->isClick)
+			{
+				RestartLevel(game);
+				fadeIn->to = PLAYING;
+				fadeIn->isStarted = true;
+			}
+		}
+
+		break;
+	default:
+		break;
+	}
+}
+
+void WriteSnapshot(const struct Game* game, struct Snapshot* snapshot)
+{
+	snapshot->state = game->state;
+	snapshot->playerPos = game->player.pos;
+	snapshot->fadeIn = game->fadeIn;
+	snapshot->fadeOut = game->fadeOut;
+	snapshot->cameraTarget = game->cameraTarget;
+	snapshot->fireTime = game->fireTime;
+	snapshot->historyCursor = game->history.cursor;
+	snapshot->historyMoveCount = game->history.moveCount;
+	snapshot->soundCount = game->soundCount;
+	snapshot->inputSequence = game->inputSequence;
+	snapshot->submittedClickTime = game->submittedClickTime;
+	memcpy(snapshot->texts, game->texts, sizeof snapshot->texts);
+
+	switch (game->state)
+	{
+	case START: snapshot->fireYoffset = 0.65f; break;
+	case LOST: snapshot->fireYoffset = 0.5f; break;
+	default: snapshot->fireYoffset = game->fireYoffset; break;
+	}
+
+	for (int i = 0; i < BOX_COUNT; i++)
+	{
+		const struct Box* box = &game->boxes[i];
+		bool hasWater = box->isMain || box->isWaterConnected;
+
+		snapshot->boxes[i] = (struct BoxSprite){
+			.source = spriteRects[(hasWater ? SPRITE_PIPE_WATER : SPRITE_PIPE) + box->id - 1],
+			.dest = box->dest,
+			.origin = box->origin,
+			.rotation = box->rotation,
+		};
+	}
+
+	const struct BoardSet* opponents = &game->opponents;
+	snapshot->opponentCount = opponents->count;
+	for (int i = 0; i < opponents->count; i++)
+	{
+		const struct SetBoard* board = &opponents->boards[i];
+		struct OpponentTile* tile = &snapshot->opponents[i];
+
+		Vector2 tilePos = {
+			(i % OPPONENT_TILES_PER_ROW) * OPPONENT_TILE_SIZE + OPPONENT_TILE_MARGIN,
+			OPPONENT_TILES_TOP + (i / OPPONENT_TILES_PER_ROW) * OPPONENT_TILE_SIZE + OPPONENT_TILE_MARGIN
+		};
+
+		for (int j = 0; j < BOX_COUNT; j++)
+		{
+			bool hasWater = board->water & (1ull << j);
+
+			tile->boxes[j] = (struct BoxSprite){
+				.source = spriteRects[(hasWater ? SPRITE_PIPE_WATER : SPRITE_PIPE) + opponents->grid[j] - 1],
+				.dest = {
+					tilePos.x + (j % COLS) * OPPONENT_CELL_SIZE + OPPONENT_CELL_SIZE / 2.f,
+					tilePos.y + (j / COLS) * OPPONENT_CELL_SIZE + OPPONENT_CELL_SIZE / 2.f,
+					OPPONENT_CELL_SIZE,
+					OPPONENT_CELL_SIZE
+				},
+				.origin = { OPPONENT_CELL_SIZE / 2.f, OPPONENT_CELL_SIZE / 2.f },
+				.rotation = board->rotations[j] * 90.f,
+			};
+		}
+
+		tile->timer = (Rectangle){ tilePos.x, tilePos.y + ROWS * OPPONENT_CELL_SIZE + 2.f, COLS * OPPONENT_CELL_SIZE, OPPONENT_TIMER_HEIGHT };
+		tile->timeFraction = opponents->levelTime > 0.f ? board->timeLeft / opponents->levelTime : 0.f;
+		tile->isCorrect = board->isCorrect;
+		tile->isLost = board->isLost;
+	}
+
+	// HOWTO, WON and END only redraw the same picture once their fade is done and
+	// the camera settled
+	snapshot->isStatic = (game->state == HOWTO || game->state == WON || game->state == END)
+		&& game->fadeOut.isCompleted && !game->fadeIn.isStarted && (GetStateAssets(game->state) & ~game->residentAssets) == 0
+		&& game->shakeDuration <= 0.f
+		&& game->cameraTarget.x == WINDOW_WIDTH / 2.0f && game->cameraTarget.y == WINDOW_HEIGHT / 2.0f;
+}
@@ -0,0 +1,189 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "raylib.h"
+
+#include "board.h"
+#include "boardset.h"
+#include "history.h"
+#include "puzzles.h"
+
+#include <stdint.h>
+
+#define GAME_WIDTH 128.f
+#define GAME_HEIGHT 128.f
+#define SCALE_FACTOR 6.f
+#define WINDOW_WIDTH (SCALE_FACTOR * GAME_WIDTH)
+#define WINDOW_HEIGHT (SCALE_FACTOR * GAME_HEIGHT)
+#define FPS 60
+#define TOTAL_COUNT 8
+#define SPACING 2
+#define ROWS PUZZLE_ROWS
+#define COLS PUZZLE_COLS
+#define BOX_COUNT 16
+#define START_POS (CELL_SIZE * SPACING)
+#define END_POS (BOX_COUNT * ROWS)
+#define FRAME_SPIKE_TIME (1.5f / FPS)
+
+// Opponent boards are tiles in the window below the board, in window pixels
+#define OPPONENT_CELL_SIZE 8.f
+#define OPPONENT_TILE_SIZE 48.f
+#define OPPONENT_TILE_MARGIN 8.f
+#define OPPONENT_TIMER_HEIGHT 4.f
+#define OPPONENT_TILES_TOP ((SPACING + ROWS) * CELL_SIZE * SCALE_FACTOR)
+#define OPPONENT_TILES_PER_ROW 16
+
+enum State
+{
+	START,
+	HOWTO,
+	PLAYING,
+	END,
+	WON,
+	LOST,
+};
+
+enum TextId
+{
+	TEXT_PLAY,
+	TEXT_LEVEL,
+	TEXT_TIME,
+	TEXT_BURNED,
+	TEXT_RESTART,
+	TEXT_WON,
+	TEXT_NEXT,
+	TEXT_END,
+	TEXT_COUNT
+};
+
+struct Player
+{
+	Vector2 pos;
+};
+
+struct Puzzle
+{
+	int puzzleGrid[ROWS][COLS];
+	bool isCorrect;
+	bool isLost;
+	float levelTime;
+};
+
+struct Text
+{
+	char text[50];
+	float fontSize;
+	float spacing;
+	int speed;
+	Color color;
+	Vector2 pos;
+	Vector2 startPos;
+	Vector2 origin;
+	Vector2 size;
+};
+
+struct Transition
+{
+	Vector2 pos;
+	Vector2 size;
+	enum State to;
+	int speed;
+	bool isStarted;
+	bool isCompleted;
+};
+
+// Everything the render thread sampled for one frame
+struct FrameInput
+{
+	uint32_t sequence;
+	float dt;
+	Vector2 mousePos;
+	bool isClick;
+	double clickTime;		// when the click was polled, for the latency report
+	bool isUndo;
+	bool isRedo;
+	float wheelMove;
+	uint32_t residentAssets;	// ASSET_BIT mask, see assets.h
+};
+
+struct BoxSprite
+{
+	Rectangle source;
+	Rectangle dest;
+	Vector2 origin;
+	float rotation;
+};
+
+// An opponent board, dest rects are in window pixels
+struct OpponentTile
+{
+	struct BoxSprite boxes[BOX_COUNT];
+	Rectangle timer;			// full width, shrinks with the time left
+	float timeFraction;
+	bool isCorrect;
+	bool isLost;
+};
+
+// Immutable copy of what one frame draws, the render thread never touches struct Game
+struct Snapshot
+{
+	enum State state;
+	struct BoxSprite boxes[BOX_COUNT];
+	Vector2 playerPos;
+	struct Text texts[TEXT_COUNT];
+	struct Transition fadeIn;
+	struct Transition fadeOut;
+	Vector2 cameraTarget;
+	float fireTime;
+	float fireYoffset;			// uniform value for the current state
+	int historyCursor;
+	int historyMoveCount;
+	struct OpponentTile opponents[BOARD_SET_MAX];
+	int opponentCount;
+
+	uint32_t soundCount;		// card sounds requested so far
+	uint32_t inputSequence;		// last FrameInput applied
+	double submittedClickTime;	// poll time of the last click that rotated a box, 0 if none yet
+	bool isStatic;				// nothing changes until the next input
+};
+
+// Simulation state: board, timer, state machine, transitions and camera
+struct Game
+{
+	enum State state;
+	struct Puzzle puzzles[TOTAL_PUZZLES];
+	int currentPuzzleIndex;
+	float currentLevelTime;		// in seconds
+
+	struct Box boxes[BOX_COUNT];
+	struct History history;
+	float historyWheel;			// wheel steps not seeked yet, trackpads scroll in fractions
+	struct Player player;
+	struct Text texts[TEXT_COUNT];
+	struct Transition fadeIn;
+	struct Transition fadeOut;
+	Font font;					// only measured, never drawn from here
+
+	Vector2 cameraTarget;
+	bool shouldCameraShake;
+	float shakeDuration;
+	float shakeIntensity;
+
+	float fireTime;
+	float fireYoffset;
+	float wrenchRotation;
+
+	struct BoardSet opponents;	// started by the caller, see StartBoardSet
+
+	uint32_t soundCount;
+	uint32_t inputSequence;
+	double submittedClickTime;
+	uint32_t residentAssets;
+};
+
+void InitGame(struct Game* game, Font font);
+void UnloadGame(struct Game* game);
+void StepGame(struct Game* game, const struct FrameInput* input);
+void WriteSnapshot(const struct Game* game, struct Snapshot* snapshot);
+
+#endif
@@ -0,0 +1,151 @@
+#include "history.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void TurnBox(struct Box* box, int quarterTurns)
+{
+	for (int i = 0; i < (quarterTurns & 3); i++)
+	{
+		RotateBox(box);
+	}
+}
+
+static void ApplyMove(struct Box* boxes, uint32_t move)
+{
+	TurnBox(&boxes[move >> 2], move & 3);
+}
+
+static void RevertMove(struct Box* boxes, uint32_t move)
+{
+	TurnBox(&boxes[move >> 2], 4 - (move & 3));
+}
+
+static void StoreKeyframe(struct History* history, struct Box* boxes)
+{
+	if (history->keyframeCount == history->keyframeCapacity)
+	{
+		history->keyframeCapacity = history->keyframeCapacity > 0 ? history->keyframeCapacity * 2 : 4;
+		history->keyframes = realloc(history->keyframes, (size_t)history->keyframeCapacity * history->keyframeSize);
+	}
+
+	uint8_t* keyframe = &history->keyframes[(size_t)history->keyframeCount * history->keyframeSize];
+	memset(keyframe, 0, history->keyframeSize);
+	for (int i = 0; i < history->boxCount; i++)
+	{
+		keyframe[i >> 2] |= ((boxes[i].rotation / 90) & 3) << ((i & 3) * 2);
+	}
+
+	history->keyframeCount += 1;
+}
+
+static void RestoreKeyframe(struct History* history, struct Box* boxes, int k)
+{
+	const uint8_t* keyframe = &history->keyframes[(size_t)k * history->keyframeSize];
+	for (int i = 0; i < history->boxCount; i++)
+	{
+		int quarterTurns = (keyframe[i >> 2] >> ((i & 3) * 2)) & 3;
+		TurnBox(&boxes[i], quarterTurns - boxes[i].rotation / 90 + 4);
+	}
+
+	history->cursor = k * history->keyframeInterval;
+}
+
+// Call right after InitBoxes, boxes is the freshly initialized board
+void ResetHistory(struct History* history, struct Box* boxes, int count)
+{
+	int keyframeSize = (count + 3) / 4;
+	if (keyframeSize != history->keyframeSize)
+	{
+		free(history->keyframes);
+		history->keyframes = NULL;
+		history->keyframeCapacity = 0;
+	}
+
+	history->boxCount = count;
+	history->keyframeSize = keyframeSize;
+	history->keyframeInterval = count / 8 > KEYFRAME_MIN_INTERVAL ? count / 8 : KEYFRAME_MIN_INTERVAL;
+	history->moveCount = 0;
+	history->cursor = 0;
+	history->keyframeCount = 0;
+
+	StoreKeyframe(history, boxes);
+}
+
+void UnloadHistory(struct History* history)
+{
+	free(history->moves);
+	free(history->keyframes);
+	*history = (struct History){ 0 };
+}
+
+// Call after the box was rotated. Drops whatever could have been redone.
+void RecordRotation(struct History* history, struct Box* boxes, int index, int quarterTurns)
+{
+	history->moveCount = history->cursor;
+	history->keyframeCount = history->cursor / history->keyframeInterval + 1;
+
+	if (history->moveCount >= HISTORY_MAX_MOVES)
+	{
+		// Keyframe 1 becomes the first, once every keyframeInterval moves at most
+		int interval = history->keyframeInterval;
+		history->moveCount -= interval;
+		history->keyframeCount -= 1;
+		memmove(history->moves, &history->moves[interval], sizeof(uint32_t) * history->moveCount);
+		memmove(history->keyframes, &history->keyframes[history->keyframeSize], (size_t)history->keyframeCount * history->keyframeSize);
+	}
+
+	if (history->moveCount == history->moveCapacity)
+	{
+		history->moveCapacity = history->moveCapacity > 0 ? history->moveCapacity * 2 : HISTORY_START_CAPACITY;
+		if (history->moveCapacity > HISTORY_MAX_MOVES) history->moveCapacity = HISTORY_MAX_MOVES;
+		history->moves = realloc(history->moves, sizeof(uint32_t) * history->moveCapacity);
+	}
+
+	history->moves[history->moveCount++] = ((uint32_t)index << 2) | (quarterTurns & 3);
+	history->cursor = history->moveCount;
+
+	if (history->moveCount % history->keyframeInterval == 0)
+	{
+		StoreKeyframe(history, boxes);
+	}
+}
+
+bool UndoRotation(struct History* history, struct Box* boxes)
+{
+	if (history->cursor == 0) return false;
+
+	history->cursor -= 1;
+	RevertMove(boxes, history->moves[history->cursor]);
+	return true;
+}
+
+bool RedoRotation(struct History* history, struct Box* boxes)
+{
+	if (history->cursor == history->moveCount) return false;
+
+	ApplyMove(boxes, history->moves[history->cursor]);
+	history->cursor += 1;
+	return true;
+}
+
+// Puts the board at the state after the given number of moves
+void SeekHistory(struct History* history, struct Box* boxes, int move)
+{
+	if (move < 0) move = 0;
+	if (move > history->moveCount) move = history->moveCount;
+
+	if (abs(move - history->cursor) > history->keyframeInterval)
+	{
+		RestoreKeyframe(history, boxes, move / history->keyframeInterval);
+	}
+
+	while (history->cursor < move)
+	{
+		ApplyMove(boxes, history->moves[history->cursor++]);
+	}
+	while (history->cursor > move)
+	{
+		RevertMove(boxes, history->moves[--history->cursor]);
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "board.h"
+
+#include <stdint.h>
+
+#define KEYFRAME_MIN_INTERVAL 64
+#define HISTORY_START_CAPACITY 256
+#define HISTORY_MAX_MOVES 16384		// 64 KB of deltas, at least one keyframe interval
+
+// Rotation history for undo, redo and seeking.
+// Every rotation is a 4 byte delta (box index << 2 | quarter turns). Every
+// keyframeInterval moves the rotations of all boxes are stored at 2 bits per box,
+// and the interval grows with the board so a keyframe never costs more than
+// 2 bytes per move. Seeking restores the nearest keyframe and replays at most
+// keyframeInterval deltas. Past HISTORY_MAX_MOVES the oldest keyframe and the
+// deltas up to the next one are dropped, so the oldest moves can't be undone.
+struct History
+{
+	uint32_t* moves;
+	int moveCount;
+	int moveCapacity;
+	int cursor;				// moves currently applied to the board
+
+	uint8_t* keyframes;		// keyframe k is the board after k * keyframeInterval moves
+	int keyframeCount;
+	int keyframeCapacity;
+	int keyframeSize;		// bytes per keyframe
+	int keyframeInterval;
+
+	int boxCount;
+};
+
+void ResetHistory(struct History* history, struct Box* boxes, int count);
+void UnloadHistory(struct History* history);
+void RecordRotation(struct History* history, struct Box* boxes, int index, int quarterTurns);
+bool UndoRotation(struct History* history, struct Box* boxes);
+bool RedoRotation(struct History* history, struct Box* boxes);
+void SeekHistory(struct History* history, struct Box* boxes, int move);
+
+#endif
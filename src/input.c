@@ -0,0 +1,288 @@
+#include "raylib.h"
+
+#include "input.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(PLATFORM_WEB)
+#include <pthread.h>
+
+// raylib doesn't expose it, but the GL library is linked in anyway
+#if defined(_WIN32)
+__declspec(dllimport) void __stdcall glFinish(void);
+#else
+void glFinish(void);
+#endif
+#endif
+
+// raylib polls input inside EndDrawing, right after the swap, and then sleeps
+// out the rest of the frame. A click polled there is only acted on in the next
+// update, so it waits the whole sleep before the game even sees it.
+//
+// When any option is on we take over frame pacing (SetTargetFPS(0) + WaitTime)
+// so the poll can be timestamped, and optionally repeated after the sleep.
+
+static struct InputConfig inputConfig;
+static bool isPacing = false;
+
+static double frameStartTime = 0.0;
+static double lastFrameTime = 0.0;
+
+static bool isClickPending = false;
+static double clickPollTime = 0.0;
+static bool isClickSubmitted = false;
+static double submittedClickTime = 0.0;
+
+static float samples[LATENCY_MAX_SAMPLES];
+static int sampleCount = 0;
+static long droppedSamples = 0;
+
+void InitInput(struct InputConfig config)
+{
+	inputConfig = config;
+	isPacing = config.isMeasuring || config.isLateSampling || config.isFrameQueueLimited;
+
+	if (isPacing) SetTargetFPS(0);
+	frameStartTime = GetTime();
+	lastFrameTime = frameStartTime;
+}
+
+struct InputConfig ParseInputArgs(int argc, char** argv, int targetFps)
+{
+	struct InputConfig config = { .targetFps = targetFps };
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--latency") == 0) config.isMeasuring = true;
+		else if (strcmp(argv[i], "--late-input") == 0) config.isLateSampling = true;
+		else if (strcmp(argv[i], "--limit-frame-queue") == 0) config.isFrameQueueLimited = true;
+	}
+
+	return config;
+}
+
+static void LatchClick(void)
+{
+	if (!isClickPending && IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
+	{
+		isClickPending = true;
+		clickPollTime = GetTime();
+	}
+}
+
+// Call at the top of the frame, returns the frame delta time.
+// Measured here instead of GetFrameTime so time spent in WaitForInputEvent can be left out.
+float BeginInputFrame(void)
+{
+	if (!isPacing)
+	{
+		double now = GetTime();
+		float dt = (float)(now - lastFrameTime);
+		lastFrameTime = now;
+		return dt;
+	}
+
+	double targetTime = 1.0 / inputConfig.targetFps;
+	double elapsed = GetTime() - frameStartTime;
+	if (elapsed < targetTime)
+	{
+		WaitTime(targetTime - elapsed);
+	}
+
+	if (inputConfig.isLateSampling)
+	{
+		// PollInputEvents moves current button state to previous, so a click seen in
+		// EndDrawing's poll is already latched and would be lost otherwise
+		PollInputEvents();
+		LatchClick();
+	}
+
+	double now = GetTime();
+	float dt = (float)(now - lastFrameTime);
+	lastFrameTime = now;
+	frameStartTime = now;
+
+	return dt;
+}
+
+bool IsClickPressed(void)
+{
+	if (!isPacing) return IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+	return isClickPending;
+}
+
+// When the click returned by IsClickPressed was polled
+double GetClickPollTime(void)
+{
+	return isPacing ? clickPollTime : GetTime();
+}
+
+// A click changed the board and its result goes out with this frame's present.
+// The simulation may run a frame or more behind, so the click is identified by its poll time.
+void MarkClickSubmitted(double clickTime)
+{
+	isClickSubmitted = true;
+	submittedClickTime = clickTime;
+}
+
+// Call right after EndDrawing
+void EndInputFrame(void)
+{
+	if (!isPacing) return;
+
+#if !defined(PLATFORM_WEB)
+	if (inputConfig.isFrameQueueLimited) glFinish();
+#endif
+
+	double presentTime = GetTime();
+
+	if (isClickSubmitted && inputConfig.isMeasuring)
+	{
+		if (sampleCount < LATENCY_MAX_SAMPLES)
+		{
+			samples[sampleCount++] = (float)((presentTime - submittedClickTime) * 1000.0);
+		}
+		else
+		{
+			droppedSamples += 1;
+		}
+	}
+
+	isClickPending = false;
+	isClickSubmitted = false;
+
+	// EndDrawing just polled, pick up clicks from it
+	LatchClick();
+}
+
+#if !defined(PLATFORM_WEB)
+struct IdleUpdater
+{
+	void (*update)(void* data);
+	void* data;
+	int isRunning;
+};
+
+static void* RunIdleUpdates(void* arg)
+{
+	struct IdleUpdater* updater = arg;
+	struct timespec period = { 0, IDLE_UPDATE_MS * 1000000 };
+
+	while (__atomic_load_n(&updater->isRunning, __ATOMIC_ACQUIRE))
+	{
+		updater->update(updater->data);
+		nanosleep(&period, NULL);
+	}
+
+	return NULL;
+}
+
+// Only the cursor moved, nothing a static screen would draw differently
+static bool IsPointerMoveOnly(void)
+{
+	Vector2 delta = GetMouseDelta();
+	if (delta.x == 0.f && delta.y == 0.f) return false;
+
+	for (int button = MOUSE_BUTTON_LEFT; button <= MOUSE_BUTTON_BACK; button++)
+	{
+		if (IsMouseButtonDown(button) || IsMouseButtonReleased(button)) return false;
+	}
+	return GetMouseWheelMove() == 0.f;
+}
+#else
+static bool HasInputEvent(void)
+{
+	for (int button = MOUSE_BUTTON_LEFT; button <= MOUSE_BUTTON_BACK; button++)
+	{
+		if (IsMouseButtonPressed(button)) return true;
+	}
+	return GetKeyPressed() != 0 || GetMouseWheelMove() != 0.f || IsWindowResized();
+}
+#endif
+
+// Call at the top of the frame instead of rendering a frame that would look like
+// the last one. Returns on the first event that isn't just the cursor moving
+// (click, key, resize, focus, close) and the frame after it runs as usual.
+//
+// Desktop blocks in glfwWaitEvents through raylib's event waiting while a helper
+// thread runs update. The web build can't block the browser, so it polls every
+// IDLE_UPDATE_MS instead, which ASYNCIFY turns into yields.
+void WaitForInputEvent(void (*update)(void* data), void* data)
+{
+#if !defined(PLATFORM_WEB)
+	struct IdleUpdater updater = { update, data, 1 };
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, RunIdleUpdates, &updater) != 0) return;
+
+	EnableEventWaiting();
+	do
+	{
+		PollInputEvents();
+	} while (IsPointerMoveOnly());
+	DisableEventWaiting();
+
+	__atomic_store_n(&updater.isRunning, 0, __ATOMIC_RELEASE);
+	pthread_join(thread, NULL);
+#else
+	do
+	{
+		update(data);
+		WaitTime(IDLE_UPDATE_MS / 1000.0);
+		PollInputEvents();
+	} while (!HasInputEvent());
+#endif
+
+	LatchClick();
+
+	// Continue as if the last frame just ended instead of jumping over the sleep
+	frameStartTime = GetTime() - 1.0 / inputConfig.targetFps;
+	lastFrameTime = frameStartTime;
+}
+
+static int CompareFloat(const void* a, const void* b)
+{
+	float x = *(const float*)a;
+	float y = *(const float*)b;
+	return (x > y) - (x < y);
+}
+
+void PrintLatencyReport(void)
+{
+	if (!inputConfig.isMeasuring) return;
+
+	printf("click-to-present latency (late input: %s, frame queue limit: %s)\n",
+		inputConfig.isLateSampling ? "on" : "off", inputConfig.isFrameQueueLimited ? "on" : "off");
+
+	if (sampleCount == 0)
+	{
+		printf("  no samples\n");
+		return;
+	}
+
+	qsort(samples, sampleCount, sizeof samples[0], CompareFloat);
+
+	double total = 0.0;
+	int buckets[LATENCY_BUCKET_COUNT] = { 0 };
+	for (int i = 0; i < sampleCount; i++)
+	{
+		total += samples[i];
+		int bucket = (int)(samples[i] / LATENCY_BUCKET_MS);
+		if (bucket >= LATENCY_BUCKET_COUNT) bucket = LATENCY_BUCKET_COUNT - 1;
+		buckets[bucket] += 1;
+	}
+
+	printf("  samples %d (dropped %ld)\n", sampleCount, droppedSamples);
+	printf("  min %.2f  mean %.2f  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f ms\n",
+		samples[0], total / sampleCount, samples[sampleCount / 2], samples[sampleCount * 9 / 10],
+		samples[sampleCount * 99 / 100], samples[sampleCount - 1]);
+
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+	{
+		if (buckets[i] == 0) continue;
+		if (i == LATENCY_BUCKET_COUNT - 1) printf("  %3d+    ms %5d\n", i * LATENCY_BUCKET_MS, buckets[i]);
+		else printf("  %3d-%-3d ms %5d\n", i * LATENCY_BUCKET_MS, (i + 1) * LATENCY_BUCKET_MS, buckets[i]);
+	}
+}
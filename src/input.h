@@ -0,0 +1,31 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+
+#define LATENCY_MAX_SAMPLES 4096
+#define LATENCY_BUCKET_MS 4
+#define LATENCY_BUCKET_COUNT 16
+#define IDLE_UPDATE_MS 20 // audio refill period while the loop sleeps
+
+struct InputConfig
+{
+	bool isMeasuring;			// record click-to-present latency and print a report on exit
+	bool isLateSampling;		// poll input again right before the update instead of a frame early
+	bool isFrameQueueLimited;	// glFinish after present so the driver can't queue frames ahead
+	int targetFps;
+};
+
+void InitInput(struct InputConfig config);
+// Reads --latency, --late-input and --limit-frame-queue
+struct InputConfig ParseInputArgs(int argc, char** argv, int targetFps);
+float BeginInputFrame(void);
+bool IsClickPressed(void);
+double GetClickPollTime(void);
+void MarkClickSubmitted(double clickTime);
+void EndInputFrame(void);
+// Sleeps until the next input event without presenting, update keeps audio streams fed meanwhile
+void WaitForInputEvent(void (*update)(void* data), void* data);
+void PrintLatencyReport(void);
+
+#endif
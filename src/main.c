@@ -1,585 +1,141 @@
 #include "raylib.h"
-#include "raymath.h"
-
-#include <stdio.h>
-
-#define GAME_WIDTH 128.f
-#define GAME_HEIGHT 128.f
-#define SCALE_FACTOR 6.f
-#define CELL_SIZE 16.f
-#define WINDOW_WIDTH (SCALE_FACTOR * GAME_WIDTH)
-#define WINDOW_HEIGHT (SCALE_FACTOR * GAME_HEIGHT)
-#define FPS 60
-#define TOTAL_COUNT 8
-#define SPACING 2
-#define ROWS 4
-#define COLS 4
-#define BOX_COUNT 16
-#define START_POS (CELL_SIZE * SPACING)
-#define END_POS (BOX_COUNT * ROWS)
-#define TOTAL_PUZZLES 4
-
-enum Direction
-{
-	TOP,
-	LEFT,
-	RIGHT,
-	BOTTOM
-};
 
-enum State
-{
-	START,
-	HOWTO,
-	PLAYING,
-	END,
-	WON,
-	LOST,
-};
-
-struct Player
-{
-	Vector2 pos;
-};
+#include "assets.h"
+#include "fire.h"
+#include "game.h"
+#include "input.h"
+#include "simulation.h"
+#include "sprites.h"
+#include "telemetry.h"
 
-struct Box
-{
-	int id;
-	int index;
-	float x;
-	float y;
-	bool isMain;
-	bool isWaterConnected;
-	int rotation;
-
-	bool isLeftOpen;
-	bool isTopOpen;
-	bool isRightOpen;
-	bool isBottomOpen;
-
-	Vector2 gridPos;
-	Vector2 size;
-	Rectangle source;
-	Rectangle dest;
-	Vector2 origin;
-
-	enum Direction direction;
-
-};
-
-struct Puzzle
-{
-	int puzzleGrid[ROWS][ROWS];
-	bool isCorrect;
-	bool isLost;
-	float levelTime;
-};
+#include <stddef.h>
 
-struct Text 
-{
-	char text[50];
-	float fontSize;
-	float spacing;
-	int speed;
-	Color color;
-	Vector2 pos;
-	Vector2 startPos;
-	Vector2 origin;
-	Vector2 size;
-};
+#define TIMELINE_HEIGHT 8.f
+#define IDLE_DELAY 2.f // seconds a static screen keeps presenting before it sleeps
 
-struct Transition
+// Music streams kept playing while a static screen sleeps
+struct IdleMusic
 {
-	Vector2 pos;
-	Vector2 size;
-	enum State to;
-	int speed;
-	bool isStarted;
-	bool isCompleted;
+	Music* streams[2];
+	int count;
 };
 
 
-void InitBoxes(struct Box boxes[BOX_COUNT], struct Puzzle puzzle);
-void DrawBoxes(struct Box boxes[BOX_COUNT], Texture2D atlasTexture);
-void RotateBox(struct Box* box);
-int GetBoxIndexByPos(struct Box boxes[BOX_COUNT], Vector2 pos);
-void CheckForAdjacentBox(struct Box boxes[BOX_COUNT], struct Box* box, Vector2 pos, Vector2 visted[BOX_COUNT]);
-Vector2 GetFontOrigin(struct Text textData);
-Vector2 GetFontSize(Font font, struct Text textData);
+void ConfigureAssets(struct Assets* assets, uint32_t readyAssets);
+void DrawBoxes(const struct BoxSprite boxes[BOX_COUNT], Texture2D spriteTexture);
+void DrawFire(const struct Assets* assets, float fireTime, float fireYoffset);
+void DrawOpponents(const struct OpponentTile* tiles, int count, Texture2D spriteTexture);
 void DrawCustomText(Font font, struct Text textData);
-void ResetFadeTransition(struct Transition* fade, bool isFadeOut);
+void UpdateIdleMusic(void* data);
 
-int main()
+int main(int argc, char** argv)
 {
 
 	InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Pipe Connections");
 	InitAudioDevice();
+	TelemetryInit("telemetry.bin");
 
 	RenderTexture2D renderTexture = LoadRenderTexture(GAME_WIDTH, GAME_HEIGHT);
 	SetTextureFilter(renderTexture.texture, TEXTURE_FILTER_POINT);
 
-	Texture2D atlasTexture = LoadTexture("assets/atlas.png");
-	Texture2D bricksTexture = LoadTexture("assets/bricks.png");
-	Texture2D noiseTexture = LoadTexture("assets/noise.png");
-	Texture2D startPageTexture = LoadTexture("assets/start_page.png");
-	Texture2D helpPageTexture = LoadTexture("assets/help_page.png");
-
-
-	Font mx16Font = LoadFont("assets/m6x11.ttf");
-
-	Sound cardSnd = LoadSound("assets/card.wav");
-	SetSoundVolume(cardSnd, 2.f);
-
-	Music fireMusic = LoadMusicStream("assets/flame.mp3");
-	SetMusicVolume(fireMusic, 0.1f);
-	PlayMusicStream(fireMusic);
-
-	Music bgMusic = LoadMusicStream("assets/bg_music.ogg");
-	SetMusicVolume(bgMusic, 0.2f);
-	PlayMusicStream(bgMusic);
+	// Decode the start screen assets in the background, only wait for what it can't draw without
+	struct Assets assets;
+	StartLoadingAssets(&assets, ParseAssetArgs(argc, argv), START);
+	WaitForAssets(&assets, (enum AssetId[]){ ASSET_SPRITES, ASSET_SDF_SHADER, ASSET_START_PAGE }, 3);
 
-	Shader fireShader = LoadShader(NULL, "assets/shaders/fire.fs");
-
-	// { 1.0f, 0.25f, 0.25f } valve red color = #ff4242
-	// { 1.0f, 0.5f, 0.0f } = orange colr = #ff8000
-	float orangeColorFloat[3] = { 1.0f, 0.5f, 0.0f };
 	Color blackColor = GetColor(0x000000ff);
 	Color whiteColor = GetColor(0xffffffff);
 	Color blueColor = GetColor(0x29adffff);
 	Color redColor = GetColor(0xff4242ff);
-	Color greenColor = GetColor(0x45e082ff);
 	Color orangeColor = GetColor(0xff8000ff);
 	Color darkBrownColor = GetColor(0x4d2b32ff);
 	Color lightBrownColor = GetColor(0x7a4841ff);
 
-	SetShaderValue(fireShader, GetShaderLocation(fireShader, "flameColor"), orangeColorFloat, SHADER_UNIFORM_VEC3);
-	SetShaderValue(fireShader, GetShaderLocation(fireShader, "animationSpeed"), (float[1]) { 0.5f }, SHADER_UNIFORM_FLOAT);
-	SetShaderValueTexture(fireShader, GetShaderLocation(fireShader, "texture0"), noiseTexture);
-
 	Camera2D camera = {};
 	camera.target = (Vector2){WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f};
 	camera.offset = (Vector2){WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f};
 	camera.rotation = 0.0f;
 	camera.zoom = 1.0f;
 
-	bool shouldCameraShake = false;
-
-	struct Player player = {
-		.pos = (Vector2){ (float)START_POS, (float)START_POS }
-	};
-	
-	struct Puzzle puzzles[TOTAL_PUZZLES];
-
-	int currentPuzzleIndex = 0;
-	puzzles[0] = (struct Puzzle){
-		.puzzleGrid = {
-			{3, 1, 2, 1},
-			{7, 12, 5, 5},
-			{12, 8, 10, 7},
-			{3, 12, 4, 11},
-		},
-		.levelTime = 60.f,
-		.isCorrect = false,
-	};
-	puzzles[1] = (struct Puzzle){
-		.puzzleGrid = {
-			{1, 1, 2, 12},
-			{12, 9, 9, 12},
-			{2, 5, 8, 12},
-			{3, 6, 5, 12}
-		},
-		.levelTime = 50.f,
-		.isCorrect = false,
-	};
-	puzzles[2] = (struct Puzzle){
-		.puzzleGrid = {
-			{11, 4, 4, 13},
-			{11, 7, 9, 13},
-			{3, 14, 8, 11},
-			{3, 6, 14, 4}
-		},
-		.levelTime = 40.f,
-		.isCorrect = false,
-	};
-	puzzles[3] = (struct Puzzle){
-		.puzzleGrid = {
-			{4, 4, 11, 14},
-			{11, 7, 9, 6},
-			{2, 9, 8, 5},
-			{1, 13, 1, 4}
-		},
-		.levelTime = 30.f,
-		.isCorrect = false,
-	};
-
-	struct Box boxes[BOX_COUNT];
-
-	InitBoxes(boxes, puzzles[currentPuzzleIndex]);
-
-	float fireTime = 0.0f;
-	float fireYoffset = 1.f;
-	float wrenchRotation = 0.f;
-
-
-	// Set all texts
-	struct Text playText = 
-	{
-		.text = "'Left Click' to play",
-		.fontSize = 32.f,
-		.spacing = 1.f,
-		.color = whiteColor,
-		.speed = 20,
-	};
-	playText.size = GetFontSize(mx16Font, playText);
-	playText.origin = GetFontOrigin(playText);
-	playText.pos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT - 200.f};
-	playText.startPos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT - 200.f};
-
-
-	struct Text levelText = 
-	{
-		.text = "Level: 1",
-		.fontSize = 32.f,
-		.spacing = 1.f,
-		.color = whiteColor,
-	};
-	levelText.size = GetFontSize(mx16Font, levelText);
-	levelText.origin = (Vector2){0.f, 0.f};
-	levelText.pos = (Vector2){10.f, 10.f};
-
-	struct Text timeText = 
-	{
-		.text = "Time: 1.0000",
-		.fontSize = 32.f,
-		.spacing = 1.f,
-		.color = whiteColor,
-	};
-	timeText.size = GetFontSize(mx16Font, timeText);
-	timeText.origin = (Vector2){0.f, 0.f};
-	timeText.pos = (Vector2){10.f, levelText.pos.y + levelText.size.y + 10.f};
-
-	struct Text burnedText = 
-	{
-		.text = "BURNNNN'd",
-		.fontSize = 64.f,
-		.spacing = 2.f,
-		.color = whiteColor,
-	};
-	burnedText.size = GetFontSize(mx16Font, burnedText);
-	burnedText.origin = GetFontOrigin(burnedText);
-	burnedText.pos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT/4.f};
-
-	struct Text restartText = 
-	{
-		.text = "'Left Click' to restart",
-		.fontSize = 32.f,
-		.spacing = 1.f,
-		.color = whiteColor,
-	};
-	restartText.size = GetFontSize(mx16Font, restartText);
-	restartText.origin = GetFontOrigin(restartText);
-	restartText.pos = (Vector2){WINDOW_WIDTH/2.f, burnedText.pos.y + burnedText.size.y + 10.f};
-
-	struct Text wonText = 
-	{
-		.text = "Doused!",
-		.fontSize = 64.f,
-		.spacing = 2.f,
-		.color = greenColor,
-	};
-	wonText.size = GetFontSize(mx16Font, wonText);
-	wonText.origin = GetFontOrigin(wonText);
-	wonText.pos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT/8.f};
-
-	struct Text nextText = 
-	{
-		.text = "'Left Click' for next level",
-		.fontSize = 32.f,
-		.spacing = 1.f,
-		.color = whiteColor,
-	};
-	nextText.size = GetFontSize(mx16Font, nextText);
-	nextText.origin = GetFontOrigin(nextText);
-	nextText.pos = (Vector2){WINDOW_WIDTH/2.f, wonText.pos.y + wonText.size.y + 10.f};
-
-	struct Text endText = 
-	{
-		.text = "Thank you for playing my game!",
-		.fontSize = 48.f,
-		.spacing = 2.f,
-		.color = whiteColor,
-	};
-	endText.size = GetFontSize(mx16Font, endText);
-	endText.origin = GetFontOrigin(endText);
-	endText.pos = (Vector2){WINDOW_WIDTH/2.f, WINDOW_HEIGHT/6.f};
-
-	struct Transition fadeOut = 
-	{
-		.pos = (Vector2){0, 0},
-		.size = (Vector2){WINDOW_WIDTH, WINDOW_HEIGHT},
-		.isCompleted = false,
-		.isStarted = true,
-		.speed = 20
-	};
-	struct Transition fadeIn = 
-	{
-		.pos = (Vector2){0, 0},
-		.size = (Vector2){WINDOW_WIDTH, 0},
-		.isCompleted = false,
-		.isStarted = false,
-		.speed = 20
-	};
-
-	enum State gameState = START;
+	// The simulation runs on its own thread from here on, this thread only
+	// samples input, plays audio and draws the newest snapshot
+	struct Game game;
+	InitGame(&game, assets.mx16Font);
+	StartBoardSet(&game.opponents, ParseBoardSetArgs(argc, argv));
+	StartSimulation(&game);
 
 	//DisableCursor();
 
 	SetTargetFPS(FPS);
-	
-	float shakeDuration = 0.0f;
-    float shakeIntensity = 4.0f;
+	InitInput(ParseInputArgs(argc, argv, FPS));
 
-	float currentLevelTime = puzzles[currentPuzzleIndex].levelTime; // in seconds
+	float idleTime = 0.f;
+	uint32_t playedSoundCount = 0;
+	double presentedClickTime = 0.0;
 
 	while (!WindowShouldClose())
 	{
-		// Common state
-		float dt = GetFrameTime();
-		fireTime += dt;
-
-		if (shouldCameraShake)
-        {
-            shakeDuration = 0.05f;
-            shakeIntensity = 1.f;
-        }
-
-		if (shakeDuration > 0.0f)
-        {
-            float offsetX = GetRandomValue(-shakeIntensity, shakeIntensity);
-            float offsetY = GetRandomValue(-shakeIntensity, shakeIntensity);
-
-            // Apply shake effect to camera target
-            camera.target.x += offsetX;
-            camera.target.y += offsetY;
-
-            shakeDuration -= dt;
-            shouldCameraShake = false;
-        }
-        else
-        {
-            camera.target = Vector2MoveTowards(camera.target, (Vector2){WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f}, 200 * dt);
-        }
-
-
-		UpdateMusicStream(bgMusic);
-
-		if (fadeOut.isStarted && !fadeOut.isCompleted) {
-			fadeOut.size = Vector2MoveTowards(fadeOut.size, (Vector2){fadeOut.size.x, 0.f}, fadeOut.speed);
-			if (fadeOut.size.y <= 0) {
-				fadeOut.isCompleted = true;
-			}
-		}  else if (fadeIn.isStarted && !fadeIn.isCompleted) {
-
-			fadeIn.size = Vector2MoveTowards(fadeIn.size, (Vector2){fadeIn.size.x, WINDOW_HEIGHT}, fadeIn.speed);
-			if (fadeIn.size.y >= WINDOW_HEIGHT) {
-				fadeIn.isCompleted = true;
-				gameState = fadeIn.to;
-				ResetFadeTransition(&fadeOut, true);
-				ResetFadeTransition(&fadeIn, false);
-			}
-		} 
+		const struct Snapshot* snapshot = GetLatestSnapshot();
 
-
-		// Update Code
-		switch (gameState)
+		// Static screens stop presenting and sleep until the next input, as long as
+		// the simulation has caught up with every input already sent
+		bool isStaticScreen = snapshot->isStatic && IsSnapshotCurrent(snapshot);
+		if (isStaticScreen && idleTime >= IDLE_DELAY)
 		{
-		case START:
-
-			if (fadeOut.isCompleted && !fadeIn.isStarted) {
-				playText.pos.y += playText.speed * dt;
-				if (playText.pos.y > playText.startPos.y + 30.f || playText.pos.y < playText.startPos.y) {
-					playText.speed *= -1;
-				}
-				if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
-				{
-					currentLevelTime = puzzles[currentPuzzleIndex].levelTime;
-					fadeIn.to = HOWTO;
-					fadeIn.isStarted = true;
-				}
-			}
-			UpdateMusicStream(fireMusic);
-			SetShaderValue(fireShader, GetShaderLocation(fireShader, "time"), &fireTime, SHADER_UNIFORM_FLOAT);
-			SetShaderValue(fireShader, GetShaderLocation(fireShader, "yOffset"), (float[1]) { 0.65f }, SHADER_UNIFORM_FLOAT);
-			
-			break;
-		case HOWTO:
-			if (fadeOut.isCompleted && !fadeIn.isStarted) {
-				playText.pos.y += playText.speed * dt;
-				if (playText.pos.y > playText.startPos.y + 30.f || playText.pos.y < playText.startPos.y) {
-					playText.speed *= -1;
-				}
-				if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
-				{
-					currentLevelTime = puzzles[currentPuzzleIndex].levelTime;
-					fadeIn.to = PLAYING;
-					fadeIn.isStarted = true;
-				}
-			}
-			UpdateMusicStream(fireMusic);
-			break;
-		case PLAYING:
-			currentLevelTime -= dt;
-			if (currentLevelTime < 0 ){
-				currentLevelTime = 0;
-			}
-			// printf("%f\n", currentLevelTime);
-			UpdateMusicStream(fireMusic);
-			SetShaderValue(fireShader, GetShaderLocation(fireShader, "time"), &fireTime, SHADER_UNIFORM_FLOAT);
-			SetShaderValue(fireShader, GetShaderLocation(fireShader, "yOffset"), (float[1]) { fireYoffset }, SHADER_UNIFORM_FLOAT);
-			if (fadeOut.isCompleted && !fadeIn.isStarted) {
-				if (!puzzles[currentPuzzleIndex].isCorrect && !puzzles[currentPuzzleIndex].isLost)
-				{
-
-					fireYoffset = 1.f * (currentLevelTime / puzzles[currentPuzzleIndex].levelTime);
-
-					if (fireYoffset <= 0.0f || currentLevelTime <= 0.f)
-					{
-						fadeIn.to = LOST;
-						fadeIn.isStarted = true;
-					}
-				}
-
-				// Set visited to -1
-				Vector2 visited[BOX_COUNT];
-				for (int i = 0; i < BOX_COUNT; i++)
-				{
-					visited[i] = (Vector2){ -1, -1 };
-				}
-
-				// Update mouse + player movement
-				Vector2 mousePosition = GetMousePosition();
-				Vector2 gridPosition = (Vector2){ floorf(mousePosition.x / (CELL_SIZE * SCALE_FACTOR)),
-						floorf(mousePosition.y / (CELL_SIZE * SCALE_FACTOR)) };
-
-				gridPosition.x = Clamp(gridPosition.x, SPACING, TOTAL_COUNT - SPACING - 1);
-				gridPosition.y = Clamp(gridPosition.y, SPACING, TOTAL_COUNT - SPACING - 1);
-
-				player.pos.x = gridPosition.x * CELL_SIZE;
-				player.pos.y = gridPosition.y * CELL_SIZE;
-
-				// Update box
-				for (int i = 0; i < ROWS; i++)
-				{
-					for (int j = 0; j < ROWS; j++)
-					{
-						int index = GetBoxIndexByPos(boxes, (Vector2) { i, j });
-
-						boxes[index].dest = (Rectangle){
-							((i + SPACING) * CELL_SIZE) + (CELL_SIZE / 2.f), ((j + SPACING) * CELL_SIZE) + (CELL_SIZE / 2.f),
-							CELL_SIZE,
-							CELL_SIZE
-						};
-
-						boxes[index].origin = (Vector2){ boxes[index].dest.width / 2.f, boxes[index].dest.height / 2.f };
-
-						if (boxes[index].x == gridPosition.x - 2 && boxes[index].y == gridPosition.y - 2 && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)
-							&& !puzzles[currentPuzzleIndex].isCorrect && !puzzles[currentPuzzleIndex].isLost)
-						{
-							RotateBox(&boxes[index]);
-							shouldCameraShake = true;
-							PlaySound(cardSnd);
-
-							wrenchRotation += 90.f;
-						}
-					}
-				}
-
-				// Set all water connection to false
-				for (int i = 0; i < BOX_COUNT; i++)
-				{
-					if (!boxes[i].isMain)
-					{
-						boxes[i].isWaterConnected = false;
-					}
-				}
-
-				// Update water present in the pipes
-				for (int i = 0; i < ROWS; i++)
-				{
-					for (int j = 0; j < ROWS; j++)
-					{
-						int index = GetBoxIndexByPos(boxes, (Vector2) { i, j });
-						if (boxes[index].isMain)
-						{
-							CheckForAdjacentBox(boxes, &boxes[index], (Vector2) { i, j }, visited);
-							break;
-						}
-					}
-				}
+			struct IdleMusic idleMusic = { { &assets.bgMusic, &assets.fireMusic }, snapshot->state == HOWTO ? 2 : 1 };
+			WaitForInputEvent(UpdateIdleMusic, &idleMusic);
+		}
 
-				snprintf(levelText.text, sizeof levelText.text, "Level: %d", currentPuzzleIndex + 1);
-				snprintf(timeText.text, sizeof timeText.text, "Time: %1.1f", currentLevelTime);
-				levelText.size = GetFontSize(mx16Font, levelText);
-				timeText.size = GetFontSize(mx16Font, timeText);
+		float dt = BeginInputFrame();
+		idleTime = isStaticScreen ? idleTime + dt : 0.f;
+
+		struct FrameInput input = {
+			.dt = dt,
+			.mousePos = GetMousePosition(),
+			.isClick = IsClickPressed(),
+			.clickTime = GetClickPollTime(),
+			.isUndo = IsKeyPressed(KEY_Z),
+			.isRedo = IsKeyPressed(KEY_Y),
+			.wheelMove = GetMouseWheelMove(),
+			.residentAssets = GetResidentAssets(&assets),
+		};
+		SubmitFrameInput(&input);
+
+		// Draw whatever the simulation finished last, this frame's input may still be in flight
+		snapshot = GetLatestSnapshot();
+		uint32_t readyAssets = UpdateAssetLoading(&assets, snapshot->state, snapshot->fadeIn.isStarted ? snapshot->fadeIn.to : snapshot->state);
+		ConfigureAssets(&assets, readyAssets);
+		bool isFireResident = assets.status[assets.isFireBaked ? ASSET_FIRE_FLIPBOOK : ASSET_FIRE_SHADER] == ASSET_RESIDENT;
+		const struct Text* texts = snapshot->texts;
+		enum State gameState = snapshot->state;
+		camera.target = snapshot->cameraTarget;
+
+		if (snapshot->soundCount != playedSoundCount)
+		{
+			PlaySound(assets.cardSnd);
+			playedSoundCount = snapshot->soundCount;
+		}
 
-				// Validate answer
-				puzzles[currentPuzzleIndex].isCorrect = true;
-				for (int i = 0; i < BOX_COUNT; i++)
-				{
-					if (!boxes[i].isWaterConnected)
-					{
-						puzzles[currentPuzzleIndex].isCorrect = false;
-					}
-				}
+		if (snapshot->submittedClickTime != presentedClickTime)
+		{
+			MarkClickSubmitted(snapshot->submittedClickTime);
+			presentedClickTime = snapshot->submittedClickTime;
+		}
 
-				if (puzzles[currentPuzzleIndex].isCorrect)
-				{
-					currentPuzzleIndex += 1;
-					if (currentPuzzleIndex < TOTAL_PUZZLES)
-					{
-						fadeIn.isStarted = true;
-						fadeIn.to = WON;
-					}
-					else
-					{
-						fadeIn.isStarted = true;
-						fadeIn.to = END;
-					}
-				}
-			}
+		UpdateMusicStream(assets.bgMusic);
 
-			break;
-		case END:
-			break;
-		case WON:
-			if (fadeOut.isCompleted && !fadeIn.isStarted) {
-				if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
-				{
-					InitBoxes(boxes, puzzles[currentPuzzleIndex]);
-					currentLevelTime = puzzles[currentPuzzleIndex].levelTime;
-					fireYoffset = 1.f;
-					fadeIn.to = PLAYING;
-					fadeIn.isStarted = true;
-				}
-			}
-			
-			break;
+		switch (gameState)
+		{
+		case START:
+		case PLAYING:
 		case LOST:
-			UpdateMusicStream(fireMusic);
-
-			SetShaderValue(fireShader, GetShaderLocation(fireShader, "time"), &fireTime, SHADER_UNIFORM_FLOAT);
-			SetShaderValue(fireShader, GetShaderLocation(fireShader, "yOffset"), (float[1]) { 0.5f }, SHADER_UNIFORM_FLOAT);
-			if (fadeOut.isCompleted && !fadeIn.isStarted) {
-				if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
-				{
-					InitBoxes(boxes, puzzles[currentPuzzleIndex]);
-					currentLevelTime = puzzles[currentPuzzleIndex].levelTime;
-					fireYoffset = 1.f;
-					fadeIn.to = PLAYING;
-					fadeIn.isStarted = true;
-				}
-			}
-			
+			UpdateMusicStream(assets.fireMusic);
+			if (!isFireResident || assets.isFireBaked) break;
+			SetShaderValue(assets.fireShader, GetShaderLocation(assets.fireShader, "time"), &snapshot->fireTime, SHADER_UNIFORM_FLOAT);
+			SetShaderValue(assets.fireShader, GetShaderLocation(assets.fireShader, "yOffset"), &snapshot->fireYoffset, SHADER_UNIFORM_FLOAT);
+			break;
+		case HOWTO:
+			UpdateMusicStream(assets.fireMusic);
 			break;
 		default:
 			break;
@@ -589,21 +145,17 @@ int main()
 		ClearBackground(whiteColor);
 
 		// Draw bricks
-		DrawTexture(bricksTexture, 0, 0, whiteColor);
+		DrawTextureRec(assets.spriteTexture, spriteRects[SPRITE_BRICKS], (Vector2){ 0, 0 }, whiteColor);
 
 		switch (gameState)
 		{
 		case START:
 			// Draw fire
-			BeginShaderMode(fireShader);
-			DrawTexture(noiseTexture, 0, 0, whiteColor);
-			EndShaderMode();
+			if (isFireResident) DrawFire(&assets, snapshot->fireTime, snapshot->fireYoffset);
 			break;
 		case PLAYING:
 			// Draw fire
-			BeginShaderMode(fireShader);
-			DrawTexture(noiseTexture, 0, 0, whiteColor);
-			EndShaderMode();
+			if (isFireResident) DrawFire(&assets, snapshot->fireTime, snapshot->fireYoffset);
 
 
 			// Draw rectangle line or background 
@@ -637,22 +189,20 @@ int main()
 			} */
 
 			// Draw boxes
-			DrawBoxes(boxes, atlasTexture);
+			DrawBoxes(snapshot->boxes, assets.spriteTexture);
 
 			// Draw player
-			DrawRectangleLines(player.pos.x, player.pos.y, CELL_SIZE, CELL_SIZE, whiteColor);			
+			DrawRectangleLines(snapshot->playerPos.x, snapshot->playerPos.y, CELL_SIZE, CELL_SIZE, whiteColor);			
 			break;
 		case END:
-			DrawBoxes(boxes, atlasTexture);
+			DrawBoxes(snapshot->boxes, assets.spriteTexture);
 			break;
 		case WON:
-			DrawBoxes(boxes, atlasTexture);
+			DrawBoxes(snapshot->boxes, assets.spriteTexture);
 			break;
 		case LOST:
-			DrawBoxes(boxes, atlasTexture);
-			BeginShaderMode(fireShader);
-			DrawTexture(noiseTexture, 0, 0, whiteColor);
-			EndShaderMode();
+			DrawBoxes(snapshot->boxes, assets.spriteTexture);
+			if (isFireResident) DrawFire(&assets, snapshot->fireTime, snapshot->fireYoffset);
 			break;
 		default:
 			break;
@@ -672,6 +222,11 @@ int main()
 
 		DrawTexturePro(renderTexture.texture, source, dest, (Vector2) { 0, 0 }, 0.f, whiteColor);
 
+		if (gameState == PLAYING || gameState == WON || gameState == LOST || gameState == END)
+		{
+			DrawOpponents(snapshot->opponents, snapshot->opponentCount, assets.spriteTexture);
+		}
+
 		// Draw custom cursor
 		/*Vector2 mousePosition = GetMousePosition();
 		DrawTextureEx(wrenchTexture, mousePosition, 0.f, 4.f, whiteColor);*/
@@ -679,54 +234,74 @@ int main()
 		switch (gameState)
 		{
 		case START:
-			DrawCustomText(mx16Font, playText);
-			DrawTexture(startPageTexture, 0, 0, whiteColor);
+			BeginShaderMode(assets.sdfShader);
+			DrawCustomText(assets.mx16Font, texts[TEXT_PLAY]);
+			EndShaderMode();
+			DrawTexture(assets.startPageTexture, 0, 0, whiteColor);
 			break;
 		case HOWTO:
-			DrawTexture(helpPageTexture, 0, 0, whiteColor);
-			DrawCustomText(mx16Font, playText);
+			DrawTexture(assets.helpPageTexture, 0, 0, whiteColor);
+			BeginShaderMode(assets.sdfShader);
+			DrawCustomText(assets.mx16Font, texts[TEXT_PLAY]);
+			EndShaderMode();
 			break;
 		case PLAYING:
-			DrawCustomText(mx16Font, levelText);
-			DrawCustomText(mx16Font, timeText);
+			BeginShaderMode(assets.sdfShader);
+			DrawCustomText(assets.mx16Font, texts[TEXT_LEVEL]);
+			DrawCustomText(assets.mx16Font, texts[TEXT_TIME]);
+			EndShaderMode();
+
+			// Rotation history timeline
+			if (snapshot->historyMoveCount > 0)
+			{
+				float timelineWidth = WINDOW_WIDTH * snapshot->historyCursor / snapshot->historyMoveCount;
+				DrawRectangle(0, WINDOW_HEIGHT - TIMELINE_HEIGHT, WINDOW_WIDTH, TIMELINE_HEIGHT, darkBrownColor);
+				DrawRectangle(0, WINDOW_HEIGHT - TIMELINE_HEIGHT, timelineWidth, TIMELINE_HEIGHT, whiteColor);
+			}
 			break;
 		case WON:
-			DrawCustomText(mx16Font, levelText);
-			DrawCustomText(mx16Font, timeText);
-			DrawCustomText(mx16Font, wonText);
-			DrawCustomText(mx16Font, nextText);
+			BeginShaderMode(assets.sdfShader);
+			DrawCustomText(assets.mx16Font, texts[TEXT_LEVEL]);
+			DrawCustomText(assets.mx16Font, texts[TEXT_TIME]);
+			DrawCustomText(assets.mx16Font, texts[TEXT_WON]);
+			DrawCustomText(assets.mx16Font, texts[TEXT_NEXT]);
+			EndShaderMode();
 			break;
 		case LOST:
-			DrawCustomText(mx16Font, burnedText);
-			DrawCustomText(mx16Font, restartText);
+			BeginShaderMode(assets.sdfShader);
+			DrawCustomText(assets.mx16Font, texts[TEXT_BURNED]);
+			DrawCustomText(assets.mx16Font, texts[TEXT_RESTART]);
+			EndShaderMode();
 			break;
 		case END:
-			DrawCustomText(mx16Font, endText);
+			BeginShaderMode(assets.sdfShader);
+			DrawCustomText(assets.mx16Font, texts[TEXT_END]);
+			EndShaderMode();
 			break;
 		default:
 			break;
 		}
 		
 		// Draw transitions		
-		if (fadeOut.isStarted && !fadeOut.isCompleted) {
-			DrawRectangleV(fadeOut.pos, fadeOut.size, blackColor);
-		} else if (fadeIn.isStarted && !fadeIn.isCompleted) {
-			DrawRectangleV(fadeIn.pos, fadeIn.size, blackColor);
+		const struct Transition* fadeOut = &snapshot->fadeOut;
+		const struct Transition* fadeIn = &snapshot->fadeIn;
+		if (fadeOut->isStarted && !fadeOut->isCompleted) {
+			DrawRectangleV(fadeOut->pos, fadeOut->size, blackColor);
+		} else if (fadeIn->isStarted && !fadeIn->isCompleted) {
+			DrawRectangleV(fadeIn->pos, fadeIn->size, blackColor);
 		}
 		EndMode2D();
 		EndDrawing();
+		EndInputFrame();
 	}
 
-	UnloadShader(fireShader);
-	UnloadMusicStream(bgMusic);
-	UnloadMusicStream(fireMusic);
-	UnloadSound(cardSnd);
-	UnloadFont(mx16Font);
-	UnloadTexture(helpPageTexture);
-	UnloadTexture(startPageTexture);
-	UnloadTexture(noiseTexture);
-	UnloadTexture(bricksTexture);
-	UnloadTexture(atlasTexture);
+	StopSimulation();
+	StopBoardSet();
+	PrintLatencyReport();
+
+	TelemetryShutdown();
+	UnloadGame(&game);
+	UnloadAssets(&assets);
 	UnloadRenderTexture(renderTexture);
 	CloseAudioDevice();
 	CloseWindow();
@@ -734,223 +309,110 @@ int main()
 	return 0;
 }
 
-void InitBoxes(struct Box boxes[BOX_COUNT], struct Puzzle puzzle)
+// Settings are lost with an evicted asset, so they are applied each time one becomes resident
+void ConfigureAssets(struct Assets* assets, uint32_t readyAssets)
 {
-	for (int i = 0; i < ROWS; i++)
+	if (readyAssets & ASSET_BIT(ASSET_SDF_SHADER))
 	{
-		for (int j = 0; j < ROWS; j++)
-		{
-			int id = puzzle.puzzleGrid[i][j];
-			int index = (i * ROWS) + j;
-
-			struct Box box = {
-				.isLeftOpen = (id == 3) || (id == 5) || (id == 7) || (id == 8) || (id == 10) || (id == 11) || (id == 13),
-				.isRightOpen = (id == 1) || (id == 5) || (id == 7) || (id == 8) || (id == 9) || (id == 12) || (id == 14),
-				.isTopOpen = (id == 4) || (id == 6) || (id == 7) || (id == 9) || (id == 10) || (id == 13) || (id == 14),
-				.isBottomOpen = (id == 2) || (id == 6) || (id == 8) || (id == 9) || (id == 10) || (id == 11) || (id == 12),
-				.index = index,
-				.x = j,
-				.y = i,
-				.isMain = id == 8,
-				.isWaterConnected = id == 8,
-				.rotation = 0,
-				.size = (Vector2){CELL_SIZE, CELL_SIZE},
-				.source = (Rectangle){
-						(id - 1) * CELL_SIZE, 0.f,
-						CELL_SIZE,
-						CELL_SIZE
-					},
-				.direction = RIGHT,
-			};
-
-			boxes[index] = box;
-		}
+		float spriteTextureSize[2] = { assets->spriteTexture.width, assets->spriteTexture.height };
+		SetShaderValue(assets->sdfShader, GetShaderLocation(assets->sdfShader, "textureSize"), spriteTextureSize, SHADER_UNIFORM_VEC2);
+		SetShaderValue(assets->sdfShader, GetShaderLocation(assets->sdfShader, "smoothing"), (float[1]) { 0.05f }, SHADER_UNIFORM_FLOAT);
 	}
-}
-
 
-void DrawBoxes(struct Box boxes[BOX_COUNT], Texture2D atlasTexture)
-{
-	for (int i = 0; i < ROWS; i++)
+	if (readyAssets & ASSET_BIT(ASSET_FIRE_SHADER))
 	{
-		for (int j = 0; j < ROWS; j++)
-		{
-			int index = (i * ROWS) + j;
-
-			if (boxes[index].isMain || boxes[index].isWaterConnected)
-			{
-				boxes[index].source.y = 16.f;
-			}
-			else
-			{
-				boxes[index].source.y = 0.f;
-			}
-			DrawTexturePro(atlasTexture, boxes[index].source, boxes[index].dest, boxes[index].origin, boxes[index].rotation, WHITE);
-		}
+		// { 1.0f, 0.25f, 0.25f } valve red color = #ff4242
+		// { 1.0f, 0.5f, 0.0f } = orange colr = #ff8000
+		float orangeColorFloat[3] = { 1.0f, 0.5f, 0.0f };
+		SetShaderValue(assets->fireShader, GetShaderLocation(assets->fireShader, "flameColor"), orangeColorFloat, SHADER_UNIFORM_VEC3);
+		SetShaderValue(assets->fireShader, GetShaderLocation(assets->fireShader, "animationSpeed"), (float[1]) { FIRE_ANIMATION_SPEED }, SHADER_UNIFORM_FLOAT);
+
+		// The noise is a sub rect of the sprite texture, the shader wraps within it
+		Rectangle noiseRect = spriteRects[SPRITE_NOISE];
+		float noiseRectUv[4] = {
+			noiseRect.x / assets->spriteTexture.width, noiseRect.y / assets->spriteTexture.height,
+			noiseRect.width / assets->spriteTexture.width, noiseRect.height / assets->spriteTexture.height
+		};
+		SetShaderValue(assets->fireShader, GetShaderLocation(assets->fireShader, "noiseRect"), noiseRectUv, SHADER_UNIFORM_VEC4);
 	}
-}
-
 
-void RotateBox(struct Box* box)
-{
-	box->rotation += 90.f;
-	if (box->rotation >= 360.f)
+	if (readyAssets & ASSET_BIT(ASSET_CARD_SOUND))
 	{
-		box->rotation = 0.f;
+		SetSoundVolume(assets->cardSnd, 2.f);
 	}
 
-	switch (box->rotation)
+	if (readyAssets & ASSET_BIT(ASSET_FIRE_MUSIC))
 	{
-	case 0:
-		box->direction = RIGHT;
-		break;
-	case 90:
-		box->direction = BOTTOM;
-		break;
-	case 180:
-		box->direction = LEFT;
-		break;
-	case 270:
-		box->direction = TOP;
-		break;
-	default:
-		break;
+		SetMusicVolume(assets->fireMusic, 0.1f);
+		PlayMusicStream(assets->fireMusic);
 	}
 
-	// valve open update
-	bool wasLeftOpen = box->isLeftOpen;
-	bool wasRightOpen = box->isRightOpen;
-	bool wasTopOpen = box->isTopOpen;
-	bool wasBottomOpen = box->isBottomOpen;
-
-	if (box->isLeftOpen) box->isLeftOpen = false;
-	if (box->isRightOpen) box->isRightOpen = false;
-	if (box->isTopOpen) box->isTopOpen = false;
-	if (box->isBottomOpen) box->isBottomOpen = false;
-
-	if (wasLeftOpen) box->isTopOpen = true;
-	if (wasRightOpen) box->isBottomOpen = true;
-	if (wasTopOpen) box->isRightOpen = true;
-	if (wasBottomOpen) box->isLeftOpen = true;
-
-}
-
-
-int GetBoxIndexByPos(struct Box boxes[BOX_COUNT], Vector2 pos)
-{
-	for (int i = 0; i < BOX_COUNT; i++)
+	if (readyAssets & ASSET_BIT(ASSET_BG_MUSIC))
 	{
-		if (boxes[i].x == pos.x && boxes[i].y == pos.y)
-		{
-			return boxes[i].index;
-		}
+		SetMusicVolume(assets->bgMusic, 0.2f);
+		PlayMusicStream(assets->bgMusic);
 	}
-	return -1;
 }
 
-
-void CheckForAdjacentBox(struct Box boxes[BOX_COUNT], struct Box* box, Vector2 pos, Vector2 visited[BOX_COUNT])
+void DrawBoxes(const struct BoxSprite boxes[BOX_COUNT], Texture2D spriteTexture)
 {
-
-	// check if already visited
 	for (int i = 0; i < BOX_COUNT; i++)
 	{
-		if (visited[i].x == pos.x && visited[i].y == pos.y)
-		{
-			return;
-		}
+		DrawTexturePro(spriteTexture, boxes[i].source, boxes[i].dest, boxes[i].origin, boxes[i].rotation, WHITE);
 	}
+}
 
-	visited[box->index] = pos;
-
-	// top
-	if (pos.y > 0)
-	{
-		Vector2 newBoxPos = (Vector2){ pos.x, pos.y - 1 };
-		int newBoxIndex = GetBoxIndexByPos(boxes, newBoxPos);
-
-		if (box->isTopOpen && boxes[newBoxIndex].isBottomOpen)
-		{
-			box->isWaterConnected = true;
-			boxes[newBoxIndex].isWaterConnected = true;
-			CheckForAdjacentBox(boxes, &boxes[newBoxIndex], newBoxPos, visited);
-		}
-
-	}
-
-	// right
-	if (pos.x < 3)
-	{
-		Vector2 newBoxPos = (Vector2){ pos.x + 1, pos.y };
-		int newBoxIndex = GetBoxIndexByPos(boxes, newBoxPos);
-
-		if (box->isRightOpen && boxes[newBoxIndex].isLeftOpen)
-		{
-			box->isWaterConnected = true;
-			boxes[newBoxIndex].isWaterConnected = true;
-			CheckForAdjacentBox(boxes, &boxes[newBoxIndex], newBoxPos, visited);
-		}
-
-	}
+// Every pipe of every tile first, then every timer, so the whole set is two
+// batches (sprite texture, then shapes) however many boards there are
+void DrawOpponents(const struct OpponentTile* tiles, int count, Texture2D spriteTexture)
+{
+	Color whiteColor = GetColor(0xffffffff);
+	Color redColor = GetColor(0xff4242ff);
+	Color greenColor = GetColor(0x45e082ff);
+	Color darkBrownColor = GetColor(0x4d2b32ff);
 
-	// bottom
-	if (pos.y < 3)
+	for (int i = 0; i < count; i++)
 	{
-		Vector2 newBoxPos = (Vector2){ pos.x, pos.y + 1 };
-		int newBoxIndex = GetBoxIndexByPos(boxes, newBoxPos);
-
-		if (box->isBottomOpen && boxes[newBoxIndex].isTopOpen)
-		{
-			box->isWaterConnected = true;
-			boxes[newBoxIndex].isWaterConnected = true;
-			CheckForAdjacentBox(boxes, &boxes[newBoxIndex], newBoxPos, visited);
-		}
-
+		DrawBoxes(tiles[i].boxes, spriteTexture);
 	}
 
-	// left
-	if (pos.x > 0)
+	for (int i = 0; i < count; i++)
 	{
-		Vector2 newBoxPos = (Vector2){ pos.x - 1, pos.y, };
-		int newBoxIndex = GetBoxIndexByPos(boxes, newBoxPos);
-
-		if (box->isLeftOpen && boxes[newBoxIndex].isRightOpen)
-		{
-			box->isWaterConnected = true;
-			boxes[newBoxIndex].isWaterConnected = true;
-			CheckForAdjacentBox(boxes, &boxes[newBoxIndex], newBoxPos, visited);
-		}
+		Rectangle timer = tiles[i].timer;
+		DrawRectangleRec(timer, darkBrownColor);
 
+		// A burned board keeps a full red timer
+		if (!tiles[i].isLost) timer.width *= tiles[i].timeFraction;
+		DrawRectangleRec(timer, tiles[i].isCorrect ? greenColor : tiles[i].isLost ? redColor : whiteColor);
 	}
-
 }
 
-
-Vector2 GetFontOrigin(struct Text textData) 
+void DrawFire(const struct Assets* assets, float fireTime, float fireYoffset)
 {
-	return (Vector2){textData.size.x/2.f, textData.size.y/2.f};
-}
+	if (assets->isFireBaked)
+	{
+		// A plain textured quad, tinted with the flameColor of fire.fs
+		Color orangeColor = GetColor(0xff8000ff);
+		DrawTextureRec(assets->fireFlipbook, GetFireFlipbookRect(assets->fireFlipbook, fireTime, fireYoffset), (Vector2){ 0, 0 }, orangeColor);
+		return;
+	}
 
-Vector2 GetFontSize(Font font, struct Text textData) 
-{
-	return MeasureTextEx(font, textData.text, textData.fontSize, textData.spacing);
+	BeginShaderMode(assets->fireShader);
+	DrawTextureRec(assets->spriteTexture, spriteRects[SPRITE_NOISE], (Vector2){ 0, 0 }, WHITE);
+	EndShaderMode();
 }
 
+// Call between one BeginShaderMode(sdfShader) / EndShaderMode pair per block of texts, so the block is one batch
 void DrawCustomText(Font font, struct Text textData) 
 {
 	DrawTextPro(font, textData.text, textData.pos, textData.origin, 0.f, textData.fontSize, textData.spacing, textData.color);
 }
 
-void ResetFadeTransition(struct Transition* fade, bool isFadeOut) 
+void UpdateIdleMusic(void* data)
 {
-
-	fade->isCompleted = false;
-	
-	if (isFadeOut) {
-		fade->size = (Vector2){WINDOW_WIDTH, WINDOW_HEIGHT};
-		fade->isStarted = true;
-	} else {
-		fade->isStarted = false;
-		fade->size = (Vector2){WINDOW_WIDTH, 0};
+	struct IdleMusic* idleMusic = data;
+	for (int i = 0; i < idleMusic->count; i++)
+	{
+		UpdateMusicStream(*idleMusic->streams[i]);
 	}
-}
\ No newline at end of file
+}
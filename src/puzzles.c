@@ -0,0 +1,40 @@
+#include "puzzles.h"
+
+const struct PuzzleData puzzleData[TOTAL_PUZZLES] = {
+	{
+		.grid = {
+			{3, 1, 2, 1},
+			{7, 12, 5, 5},
+			{12, 8, 10, 7},
+			{3, 12, 4, 11},
+		},
+		.levelTime = 60.f,
+	},
+	{
+		.grid = {
+			{1, 1, 2, 12},
+			{12, 9, 9, 12},
+			{2, 5, 8, 12},
+			{3, 6, 5, 12}
+		},
+		.levelTime = 50.f,
+	},
+	{
+		.grid = {
+			{11, 4, 4, 13},
+			{11, 7, 9, 13},
+			{3, 14, 8, 11},
+			{3, 6, 14, 4}
+		},
+		.levelTime = 40.f,
+	},
+	{
+		.grid = {
+			{4, 4, 11, 14},
+			{11, 7, 9, 6},
+			{2, 9, 8, 5},
+			{1, 13, 1, 4}
+		},
+		.levelTime = 30.f,
+	},
+};
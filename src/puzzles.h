@@ -0,0 +1,18 @@
+#ifndef PUZZLES_H
+#define PUZZLES_H
+
+#define PUZZLE_ROWS 4
+#define PUZZLE_COLS 4
+#define TOTAL_PUZZLES 4
+
+// Level layouts, shared by the game and the headless validator so neither
+// needs raylib to know what a level looks like.
+struct PuzzleData
+{
+	int grid[PUZZLE_ROWS][PUZZLE_COLS];
+	float levelTime;
+};
+
+extern const struct PuzzleData puzzleData[TOTAL_PUZZLES];
+
+#endif
@@ -0,0 +1,212 @@
+#include "simulation.h"
+
+#if !defined(PLATFORM_WEB)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#define SNAPSHOT_FRESH 4 // or'd into middle while it holds a snapshot the render thread hasn't taken
+
+// Render thread -> simulation. head is only written by the render thread, tail
+// only by the simulation, same scheme as the telemetry ring.
+struct InputQueue
+{
+	struct FrameInput inputs[INPUT_QUEUE_SIZE];
+	uint32_t head __attribute__((aligned(64)));
+	uint32_t tail __attribute__((aligned(64)));
+};
+
+// Simulation -> render thread. The simulation owns slots[back], the render
+// thread owns slots[front] and finished snapshots are swapped through middle,
+// so a new snapshot never waits for the reader and the reader always gets the newest.
+struct SnapshotBuffer
+{
+	struct Snapshot slots[3];
+	int back;
+	int middle __attribute__((aligned(64)));
+	int front __attribute__((aligned(64)));
+};
+
+static struct Game* simulatedGame;
+static struct InputQueue queue;
+static struct SnapshotBuffer snapshots;
+static bool isThreaded = false;
+
+// Render thread only
+static uint32_t submittedSequence = 0;
+static struct FrameInput pendingInput;
+static bool hasPendingInput = false;
+
+#if !defined(PLATFORM_WEB)
+static pthread_t simulationThread;
+// Only for sleeping while the queue is empty, the data itself is lock free
+static pthread_mutex_t wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wakeCond = PTHREAD_COND_INITIALIZER;
+static bool shouldStop = false;
+#endif
+
+// Steps every queued input and publishes the result once
+static void StepQueuedInputs(void)
+{
+	uint32_t head = __atomic_load_n(&queue.head, __ATOMIC_ACQUIRE);
+	uint32_t tail = queue.tail;
+	if (head == tail) return;
+
+	for (; tail != head; tail++)
+	{
+		StepGame(simulatedGame, &queue.inputs[tail & (INPUT_QUEUE_SIZE - 1)]);
+	}
+	__atomic_store_n(&queue.tail, tail, __ATOMIC_RELEASE);
+
+	WriteSnapshot(simulatedGame, &snapshots.slots[snapshots.back]);
+	snapshots.back = __atomic_exchange_n(&snapshots.middle, snapshots.back | SNAPSHOT_FRESH, __ATOMIC_ACQ_REL) & 3;
+}
+
+#if !defined(PLATFORM_WEB)
+static bool IsQueueEmpty(void)
+{
+	return __atomic_load_n(&queue.head, __ATOMIC_ACQUIRE) == queue.tail;
+}
+
+static void* SimulationLoop(void* arg)
+{
+	(void)arg;
+
+	while (true)
+	{
+		StepQueuedInputs();
+
+		pthread_mutex_lock(&wakeMutex);
+		while (IsQueueEmpty() && !shouldStop)
+		{
+			pthread_cond_wait(&wakeCond, &wakeMutex);
+		}
+		bool isStopping = shouldStop;
+		pthread_mutex_unlock(&wakeMutex);
+
+		if (isStopping) break;
+	}
+
+	return NULL;
+}
+#endif
+
+void StartSimulation(struct Game* game)
+{
+	simulatedGame = game;
+	snapshots.back = 0;
+	snapshots.middle = 1;
+	snapshots.front = 2;
+	WriteSnapshot(game, &snapshots.slots[snapshots.front]);
+
+#if !defined(PLATFORM_WEB)
+	// Without the thread SubmitFrameInput steps inline, like the web build
+	shouldStop = false;
+	isThreaded = pthread_create(&simulationThread, NULL, SimulationLoop, NULL) == 0;
+#endif
+}
+
+void StopSimulation(void)
+{
+#if !defined(PLATFORM_WEB)
+	if (isThreaded)
+	{
+		pthread_mutex_lock(&wakeMutex);
+		shouldStop = true;
+		pthread_cond_signal(&wakeCond);
+		pthread_mutex_unlock(&wakeMutex);
+
+		pthread_join(simulationThread, NULL);
+		isThreaded = false;
+	}
+#endif
+}
+
+// from is the newer input, at most one of the two holds a click. A click keeps
+// the cursor position it was made at.
+static void MergeInput(struct FrameInput* into, const struct FrameInput* from)
+{
+	into->dt += from->dt;
+	if (!into->isClick)
+	{
+		into->mousePos = from->mousePos;
+		into->isClick = from->isClick;
+		into->clickTime = from->clickTime;
+	}
+	into->isUndo |= from->isUndo;
+	into->isRedo |= from->isRedo;
+	into->wheelMove += from->wheelMove;
+	into->residentAssets = from->residentAssets;
+}
+
+// Returns false when the simulation is a whole queue behind
+static bool PushInput(const struct FrameInput* input)
+{
+	uint32_t head = queue.head;
+	uint32_t tail = __atomic_load_n(&queue.tail, __ATOMIC_ACQUIRE);
+	if (head - tail == INPUT_QUEUE_SIZE) return false;
+
+	queue.inputs[head & (INPUT_QUEUE_SIZE - 1)] = *input;
+	__atomic_store_n(&queue.head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+void SubmitFrameInput(struct FrameInput* input)
+{
+	if (hasPendingInput && pendingInput.isClick && input->isClick)
+	{
+		// Two clicks can't share an input and neither may be lost, so this frame
+		// waits for the simulation to make room for the older one. The queue is
+		// only ever full with the thread running, it isn't waiting on us.
+		while (!PushInput(&pendingInput))
+		{
+#if !defined(PLATFORM_WEB)
+			sched_yield();
+#endif
+		}
+		hasPendingInput = false;
+	}
+	else if (hasPendingInput)
+	{
+		MergeInput(&pendingInput, input);
+		*input = pendingInput;
+		hasPendingInput = false;
+	}
+
+	input->sequence = ++submittedSequence;
+
+	if (!PushInput(input))
+	{
+		// The simulation is a whole queue behind, keep this one for the next frame
+		pendingInput = *input;
+		hasPendingInput = true;
+		return;
+	}
+
+	if (!isThreaded)
+	{
+		StepQueuedInputs();
+		return;
+	}
+
+#if !defined(PLATFORM_WEB)
+	pthread_mutex_lock(&wakeMutex);
+	pthread_cond_signal(&wakeCond);
+	pthread_mutex_unlock(&wakeMutex);
+#endif
+}
+
+const struct Snapshot* GetLatestSnapshot(void)
+{
+	if (__atomic_load_n(&snapshots.middle, __ATOMIC_ACQUIRE) & SNAPSHOT_FRESH)
+	{
+		snapshots.front = __atomic_exchange_n(&snapshots.middle, snapshots.front, __ATOMIC_ACQ_REL) & 3;
+	}
+
+	return &snapshots.slots[snapshots.front];
+}
+
+bool IsSnapshotCurrent(const struct Snapshot* snapshot)
+{
+	return !hasPendingInput && snapshot->inputSequence == submittedSequence;
+}
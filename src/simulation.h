@@ -0,0 +1,21 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "game.h"
+
+#define INPUT_QUEUE_SIZE 64 // must be a power of two
+
+// Runs StepGame on its own thread. The render thread hands over one FrameInput
+// per frame through a single producer / single consumer queue and reads back
+// the newest Snapshot through a triple buffer, neither side ever takes a lock
+// on the data. The web build has no threads and steps inline in SubmitFrameInput.
+void StartSimulation(struct Game* game);
+void StopSimulation(void);
+// Fills in input->sequence. When the queue is full the input is merged into the next one.
+void SubmitFrameInput(struct FrameInput* input);
+// The render thread's view, stays valid until the next call
+const struct Snapshot* GetLatestSnapshot(void);
+// True once the snapshot reflects every submitted input
+bool IsSnapshotCurrent(const struct Snapshot* snapshot);
+
+#endif
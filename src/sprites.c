@@ -0,0 +1,18 @@
+#include "sprites.h"
+
+// Generated by 'make sprites'
+#include "sprite_rects.h"
+
+// The glyphs were rasterized into the sprite texture at build time. The font
+// only borrows the texture and the static tables, so it must not go through UnloadFont.
+Font GetSpriteFont(Texture2D spriteTexture)
+{
+	return (Font){
+		.baseSize = FONT_BASE_SIZE,
+		.glyphCount = FONT_GLYPH_COUNT,
+		.glyphPadding = FONT_GLYPH_PADDING,
+		.texture = spriteTexture,
+		.recs = fontGlyphRects,
+		.glyphs = fontGlyphs,
+	};
+}
@@ -0,0 +1,35 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include "raylib.h"
+
+// Every sprite and font glyph lives in one texture, assets/sprites.png,
+// packed at build time by tools/pack_sprites.c. The rects come from the
+// generated sprite_rects.h. The start and help pages stay separate textures so
+// they can be unloaded with their screens, see assets.h.
+
+#define PIPE_COUNT 14
+#define SPRITE_PADDING 1
+
+// Glyphs are baked once as signed distance fields, so every text size is drawn
+// from the same glyphs through assets/shaders/sdf.fs
+#define FONT_BASE_SIZE 32
+#define FONT_GLYPH_COUNT 95
+#define FONT_GLYPH_PADDING 4
+
+enum SpriteId
+{
+	SPRITE_PIPE,											// PIPE_COUNT dry pipes, by pipe id - 1
+	SPRITE_PIPE_WATER = SPRITE_PIPE + PIPE_COUNT,			// PIPE_COUNT pipes with water, by pipe id - 1
+	SPRITE_BRICKS = SPRITE_PIPE_WATER + PIPE_COUNT,
+	SPRITE_NOISE,
+	SPRITE_COUNT
+};
+
+extern Rectangle spriteRects[SPRITE_COUNT];
+extern Rectangle fontGlyphRects[FONT_GLYPH_COUNT];
+extern GlyphInfo fontGlyphs[FONT_GLYPH_COUNT];
+
+Font GetSpriteFont(Texture2D spriteTexture);
+
+#endif
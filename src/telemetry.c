@@ -0,0 +1,188 @@
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(PLATFORM_WEB)
+#include <pthread.h>
+#endif
+
+// Single producer (game thread) / single consumer (writer thread) ring.
+// head is only written by the producer, tail only by the consumer, so a pair of
+// acquire/release atomics is all the synchronization needed.
+struct TelemetryRing
+{
+	struct TelemetryEvent events[TELEMETRY_RING_SIZE];
+	uint32_t head __attribute__((aligned(64)));
+	uint32_t tail __attribute__((aligned(64)));
+	uint64_t dropped __attribute__((aligned(64)));
+};
+
+static struct TelemetryRing ring;
+static FILE* logFile = NULL;
+static bool isRunning = false;
+static struct timespec startTime;
+
+#if !defined(PLATFORM_WEB)
+static pthread_t writerThread;
+static int shouldStop = 0;
+#endif
+
+static uint64_t GetElapsedUs(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)(now.tv_sec - startTime.tv_sec) * 1000000u + (uint64_t)((now.tv_nsec - startTime.tv_nsec) / 1000);
+}
+
+#if !defined(PLATFORM_WEB)
+static uint32_t DrainRing(struct TelemetryEvent batch[TELEMETRY_BATCH_SIZE])
+{
+	uint32_t tail = ring.tail;
+	uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+	uint32_t count = head - tail;
+
+	if (count > TELEMETRY_BATCH_SIZE) count = TELEMETRY_BATCH_SIZE;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		batch[i] = ring.events[(tail + i) & (TELEMETRY_RING_SIZE - 1)];
+	}
+
+	__atomic_store_n(&ring.tail, tail + count, __ATOMIC_RELEASE);
+	return count;
+}
+
+static void* WriterLoop(void* arg)
+{
+	(void)arg;
+	struct TelemetryEvent batch[TELEMETRY_BATCH_SIZE];
+	uint64_t lastFlushUs = GetElapsedUs();
+	bool isDirty = false;
+
+	for (;;)
+	{
+		bool isStopping = __atomic_load_n(&shouldStop, __ATOMIC_ACQUIRE);
+		uint32_t count = DrainRing(batch);
+
+		if (count > 0)
+		{
+			fwrite(batch, sizeof(struct TelemetryEvent), count, logFile);
+			isDirty = true;
+		}
+
+		// Batch flushes so the disk sees a few writes per second at most
+		uint64_t nowUs = GetElapsedUs();
+		if (isDirty && (nowUs - lastFlushUs >= TELEMETRY_FLUSH_MS * 1000u || isStopping))
+		{
+			fflush(logFile);
+			lastFlushUs = nowUs;
+			isDirty = false;
+		}
+
+		if (count == TELEMETRY_BATCH_SIZE) continue;
+		if (isStopping && count == 0) break;
+
+		struct timespec idle = { 0, 10 * 1000000 };
+		nanosleep(&idle, NULL);
+	}
+
+	return NULL;
+}
+#endif
+
+bool TelemetryInit(const char* path)
+{
+#if defined(PLATFORM_WEB)
+	// No threads in the web build, telemetry stays off
+	(void)path;
+	return false;
+#else
+	// Appended to, so a crash and relaunch keeps the log of the crashed session
+	logFile = fopen(path, "ab");
+	if (logFile == NULL)
+	{
+		return false;
+	}
+
+	fseek(logFile, 0, SEEK_END);
+	long size = ftell(logFile);
+	if (size <= 0)
+	{
+		struct TelemetryHeader header = { .version = TELEMETRY_VERSION, .eventSize = sizeof(struct TelemetryEvent) };
+		memcpy(header.magic, TELEMETRY_MAGIC, sizeof header.magic);
+		fwrite(&header, sizeof header, 1, logFile);
+	}
+	else
+	{
+		// A crash can cut the last event short, zero pad it so this session starts on a whole event
+		static const uint8_t padding[sizeof(struct TelemetryEvent)];
+		long partial = (size - (long)sizeof(struct TelemetryHeader)) % (long)sizeof(struct TelemetryEvent);
+		if (partial > 0) fwrite(padding, 1, sizeof padding - partial, logFile);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+	ring.head = 0;
+	ring.tail = 0;
+	ring.dropped = 0;
+	shouldStop = 0;
+
+	if (pthread_create(&writerThread, NULL, WriterLoop, NULL) != 0)
+	{
+		fclose(logFile);
+		logFile = NULL;
+		return false;
+	}
+
+	isRunning = true;
+	TelemetryRecord(TELEMETRY_SESSION_START, 0, 0, 0, 0.f);
+	return true;
+#endif
+}
+
+void TelemetryShutdown(void)
+{
+	if (!isRunning) return;
+	TelemetryRecord(TELEMETRY_SESSION_END, 0, 0, 0, (float)ring.dropped);
+	isRunning = false;
+
+#if !defined(PLATFORM_WEB)
+	__atomic_store_n(&shouldStop, 1, __ATOMIC_RELEASE);
+	pthread_join(writerThread, NULL);
+#endif
+
+	fclose(logFile);
+	logFile = NULL;
+}
+
+// Game thread only. Never blocks: when the writer falls behind the event is dropped and counted.
+void TelemetryRecord(uint8_t type, uint8_t level, uint8_t a, uint8_t b, float value)
+{
+	if (!isRunning) return;
+
+	uint32_t head = ring.head;
+	uint32_t tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE);
+
+	if (head - tail >= TELEMETRY_RING_SIZE)
+	{
+		ring.dropped += 1;
+		return;
+	}
+
+	ring.events[head & (TELEMETRY_RING_SIZE - 1)] = (struct TelemetryEvent){
+		.timeUs = GetElapsedUs(),
+		.type = type,
+		.level = level,
+		.a = a,
+		.b = b,
+		.value = value,
+	};
+
+	__atomic_store_n(&ring.head, head + 1, __ATOMIC_RELEASE);
+}
+
+uint64_t TelemetryDroppedCount(void)
+{
+	return ring.dropped;
+}
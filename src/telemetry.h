@@ -0,0 +1,47 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TELEMETRY_MAGIC "PCTL"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_RING_SIZE 4096 // must be a power of two
+#define TELEMETRY_BATCH_SIZE 256
+#define TELEMETRY_FLUSH_MS 250
+
+enum TelemetryEventType
+{
+	TELEMETRY_SESSION_START = 1,
+	TELEMETRY_STATE_CHANGE,
+	TELEMETRY_ROTATE_BOX,
+	TELEMETRY_FRAME_SPIKE,
+	TELEMETRY_SESSION_END,
+};
+
+// Fixed 16 byte record, written to disk as-is (little endian)
+struct TelemetryEvent
+{
+	uint64_t timeUs;	// microseconds since TelemetryInit of its session
+	uint8_t type;		// enum TelemetryEventType
+	uint8_t level;		// current puzzle index
+	uint8_t a;			// STATE_CHANGE: from state, ROTATE_BOX: box index
+	uint8_t b;			// STATE_CHANGE: to state, ROTATE_BOX: rotation / 90
+	float value;		// level time left, frame time in ms for FRAME_SPIKE, dropped events for SESSION_END
+};
+
+// File header, followed by a flat array of struct TelemetryEvent. Every launch
+// appends its session, starting with a SESSION_START event.
+struct TelemetryHeader
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t eventSize;
+};
+
+bool TelemetryInit(const char* path);
+void TelemetryShutdown(void);
+void TelemetryRecord(uint8_t type, uint8_t level, uint8_t a, uint8_t b, float value);
+uint64_t TelemetryDroppedCount(void);
+
+#endif
@@ -0,0 +1,112 @@
+#include "validator.h"
+
+#define MAIN_PIPE_ID 8
+
+// Indexed by pipe id, matches the isXOpen tests in InitBoxes
+static const uint8_t pipeSides[15] = {
+	[1] = SIDE_RIGHT,
+	[2] = SIDE_BOTTOM,
+	[3] = SIDE_LEFT,
+	[4] = SIDE_TOP,
+	[5] = SIDE_LEFT | SIDE_RIGHT,
+	[6] = SIDE_TOP | SIDE_BOTTOM,
+	[7] = SIDE_LEFT | SIDE_RIGHT | SIDE_TOP,
+	[8] = SIDE_LEFT | SIDE_RIGHT | SIDE_BOTTOM,
+	[9] = SIDE_RIGHT | SIDE_TOP | SIDE_BOTTOM,
+	[10] = SIDE_LEFT | SIDE_TOP | SIDE_BOTTOM,
+	[11] = SIDE_LEFT | SIDE_BOTTOM,
+	[12] = SIDE_RIGHT | SIDE_BOTTOM,
+	[13] = SIDE_LEFT | SIDE_TOP,
+	[14] = SIDE_RIGHT | SIDE_TOP,
+};
+
+uint8_t GetPipeSides(int id)
+{
+	return id >= 0 && id < 15 ? pipeSides[id] : 0;
+}
+
+// One clockwise quarter turn: left -> top, top -> right, right -> bottom, bottom -> left
+static uint8_t TurnSides(uint8_t sides)
+{
+	uint8_t turned = 0;
+	if (sides & SIDE_LEFT) turned |= SIDE_TOP;
+	if (sides & SIDE_TOP) turned |= SIDE_RIGHT;
+	if (sides & SIDE_RIGHT) turned |= SIDE_BOTTOM;
+	if (sides & SIDE_BOTTOM) turned |= SIDE_LEFT;
+	return turned;
+}
+
+uint8_t RotateSides(uint8_t sides, int quarterTurns)
+{
+	for (int i = 0; i < (quarterTurns & 3); i++)
+	{
+		sides = TurnSides(sides);
+	}
+	return sides;
+}
+
+bool InitValidatorPuzzle(struct ValidatorPuzzle* puzzle, const int* grid, int rows, int cols)
+{
+	int count = rows * cols;
+	// a single 64 cell row would shift a bitboard by its full width
+	if (rows <= 0 || cols <= 0 || cols >= 64 || count > VALIDATOR_MAX_CELLS) return false;
+
+	*puzzle = (struct ValidatorPuzzle){
+		.rows = rows,
+		.cols = cols,
+		.count = count,
+		.all = count == 64 ? ~0ull : (1ull << count) - 1,
+	};
+
+	for (int i = 0; i < count; i++)
+	{
+		uint8_t sides = GetPipeSides(grid[i]);
+		for (int r = 0; r < 4; r++)
+		{
+			puzzle->sides[i][r] = RotateSides(sides, r);
+		}
+
+		if (grid[i] == MAIN_PIPE_ID) puzzle->mains |= 1ull << i;
+		if (i % cols != cols - 1) puzzle->notLastCol |= 1ull << i;
+	}
+
+	return true;
+}
+
+uint64_t GetWaterMask(const struct ValidatorPuzzle* puzzle, const uint8_t* rotations)
+{
+	// Spread the rotated sides into one bitboard per direction
+	uint64_t left = 0, right = 0, top = 0, bottom = 0;
+	for (int i = 0; i < puzzle->count; i++)
+	{
+		uint64_t bit = 1ull << i;
+		uint8_t sides = puzzle->sides[i][rotations[i] & 3];
+		if (sides & SIDE_LEFT) left |= bit;
+		if (sides & SIDE_RIGHT) right |= bit;
+		if (sides & SIDE_TOP) top |= bit;
+		if (sides & SIDE_BOTTOM) bottom |= bit;
+	}
+
+	// A link exists where two facing sides are both open, flood along the links from the mains
+	int cols = puzzle->cols;
+	uint64_t linkRight = right & puzzle->notLastCol & (left >> 1);
+	uint64_t linkDown = bottom & (top >> cols);
+
+	uint64_t water = puzzle->mains;
+	uint64_t last = 0;
+	while (water != last)
+	{
+		last = water;
+		water |= ((water & linkRight) << 1)
+			| ((water >> 1) & linkRight)
+			| ((water & linkDown) << cols)
+			| ((water >> cols) & linkDown);
+	}
+
+	return water & puzzle->all;
+}
+
+bool ValidateRotations(const struct ValidatorPuzzle* puzzle, const uint8_t* rotations)
+{
+	return GetWaterMask(puzzle, rotations) == puzzle->all;
+}
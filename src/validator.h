@@ -0,0 +1,41 @@
+#ifndef VALIDATOR_H
+#define VALIDATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define VALIDATOR_MAX_CELLS 64
+
+// Open side bits of a pipe
+#define SIDE_LEFT 1
+#define SIDE_RIGHT 2
+#define SIDE_TOP 4
+#define SIDE_BOTTOM 8
+
+// Headless solution check, no raylib types. A board is at most 64 cells so
+// every open side direction fits in one 64 bit bitboard (bit = row * cols + col).
+struct ValidatorPuzzle
+{
+	int rows;
+	int cols;
+	int count;
+	uint8_t sides[VALIDATOR_MAX_CELLS][4];	// open sides per cell per quarter turn
+	uint64_t mains;							// cells holding a main pipe
+	uint64_t all;
+	uint64_t notLastCol;
+};
+
+// Same open sides as InitBoxes, a quarter turn maps them like RotateBox
+uint8_t GetPipeSides(int id);
+uint8_t RotateSides(uint8_t sides, int quarterTurns);
+
+// grid is rows * cols pipe ids, row major. Returns false if the board does not fit.
+bool InitValidatorPuzzle(struct ValidatorPuzzle* puzzle, const int* grid, int rows, int cols);
+
+// rotations holds one quarter turn count (0-3) per cell, row major.
+// Returns the cells connected to the water, mains included, like isWaterConnected.
+uint64_t GetWaterMask(const struct ValidatorPuzzle* puzzle, const uint8_t* rotations);
+// Returns true when every pipe is connected to the water, like UpdateWater.
+bool ValidateRotations(const struct ValidatorPuzzle* puzzle, const uint8_t* rotations);
+
+#endif
@@ -0,0 +1,415 @@
+// Microbenchmarks for the board operations in src/board.c on generated boards
+// from 4x4 up to 1024x1024. Prints a table, and with a path argument also
+// writes the results as json for CI to compare against a baseline.
+// Usage: bench_board [results.json]
+
+#include "../src/board.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define MIN_SIZE 4
+#define MAX_SIZE 1024
+#define MIN_BENCH_TIME 0.2
+#define RANDOM_OP_COUNT 4096
+#define MAX_RESULTS 64
+
+// CheckForAdjacentBox and the win check scan every box per visited box, past
+// this they take seconds per call and the recursion gets deep
+#define QUADRATIC_MAX_CELLS (128 * 128)
+
+enum Side
+{
+	SIDE_LEFT = 1,
+	SIDE_RIGHT = 2,
+	SIDE_TOP = 4,
+	SIDE_BOTTOM = 8,
+};
+
+// Pipe id for each set of open sides, see InitBoxes. There is no four way pipe.
+static const int maskToId[16] = {
+	[SIDE_RIGHT] = 1,
+	[SIDE_BOTTOM] = 2,
+	[SIDE_LEFT] = 3,
+	[SIDE_TOP] = 4,
+	[SIDE_LEFT | SIDE_RIGHT] = 5,
+	[SIDE_TOP | SIDE_BOTTOM] = 6,
+	[SIDE_LEFT | SIDE_RIGHT | SIDE_TOP] = 7,
+	[SIDE_LEFT | SIDE_RIGHT | SIDE_BOTTOM] = 8,
+	[SIDE_RIGHT | SIDE_TOP | SIDE_BOTTOM] = 9,
+	[SIDE_LEFT | SIDE_TOP | SIDE_BOTTOM] = 10,
+	[SIDE_LEFT | SIDE_BOTTOM] = 11,
+	[SIDE_RIGHT | SIDE_BOTTOM] = 12,
+	[SIDE_LEFT | SIDE_TOP] = 13,
+	[SIDE_RIGHT | SIDE_TOP] = 14,
+};
+
+struct BenchBoard
+{
+	int rows;
+	int cols;
+	int* grid;
+	unsigned char* rotations;	// applied after InitBoxes
+	struct Box* boxes;
+	Vector2* visited;
+	int* randomIndices;
+	Vector2* randomPositions;
+};
+
+struct BenchResult
+{
+	const char* op;
+	int size;
+	bool isSkipped;
+	long iterations;
+	double nsPerOp;
+	double opsPerSec;
+	bool hasCounters;
+	double cacheRefsPerOp;
+	double cacheMissesPerOp;
+};
+
+typedef void (*BenchOp)(struct BenchBoard* board, long iterations);
+
+static struct BenchResult results[MAX_RESULTS];
+static int resultCount = 0;
+static unsigned int randomState = 0x9e3779b9u;
+static volatile int sink;
+
+static unsigned int NextRandom(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static double GetSeconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int CountSides(int mask)
+{
+	return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+}
+
+// Solved board: a random spanning tree of pipes grown from a main pipe in the
+// middle of the top row, so the water has to reach every box.
+static void GenerateBoard(struct BenchBoard* board, int size)
+{
+	int count = size * size;
+	board->rows = size;
+	board->cols = size;
+	board->grid = malloc(sizeof(int) * count);
+	board->rotations = calloc(count, 1);
+	board->boxes = malloc(sizeof(struct Box) * count);
+	board->visited = malloc(sizeof(Vector2) * count);
+	board->randomIndices = malloc(sizeof(int) * RANDOM_OP_COUNT);
+	board->randomPositions = malloc(sizeof(Vector2) * RANDOM_OP_COUNT);
+
+	unsigned char* masks = calloc(count, 1);
+	bool* isReached = calloc(count, sizeof(bool));
+	int* stack = malloc(sizeof(int) * count);
+	int stackSize = 0;
+
+	const int dx[4] = { -1, 1, 0, 0 };
+	const int dy[4] = { 0, 0, -1, 1 };
+	const int side[4] = { SIDE_LEFT, SIDE_RIGHT, SIDE_TOP, SIDE_BOTTOM };
+	const int opposite[4] = { SIDE_RIGHT, SIDE_LEFT, SIDE_BOTTOM, SIDE_TOP };
+
+	int root = size / 2;
+	isReached[root] = true;
+	for (int d = 0; d < 4; d++)
+	{
+		if (d == 2) continue;
+		int next = root + dy[d] * size + dx[d];
+		masks[root] |= side[d];
+		masks[next] |= opposite[d];
+		isReached[next] = true;
+		stack[stackSize++] = next;
+	}
+
+	while (stackSize > 0)
+	{
+		int cell = stack[stackSize - 1];
+		int x = cell % size;
+		int y = cell / size;
+
+		int options[4];
+		int optionCount = 0;
+		if (CountSides(masks[cell]) < 3)
+		{
+			for (int d = 0; d < 4; d++)
+			{
+				int nx = x + dx[d];
+				int ny = y + dy[d];
+				if (nx >= 0 && nx < size && ny >= 0 && ny < size && !isReached[ny * size + nx]) options[optionCount++] = d;
+			}
+		}
+
+		if (optionCount == 0)
+		{
+			stackSize--;
+			continue;
+		}
+
+		int d = options[NextRandom() % optionCount];
+		int next = (y + dy[d]) * size + x + dx[d];
+		masks[cell] |= side[d];
+		masks[next] |= opposite[d];
+		isReached[next] = true;
+		stack[stackSize++] = next;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		int id = maskToId[masks[i]];
+		if (!isReached[i] || id == 0)
+		{
+			// Boxes the tree couldn't reach with three sided pipes
+			id = 1 + NextRandom() % 7;
+		}
+		else if (id == MAIN_PIPE_ID && i != root)
+		{
+			// Only the root is the main pipe, the same shape is a turned around 7
+			id = 7;
+			board->rotations[i] = 2;
+		}
+		board->grid[i] = id;
+	}
+
+	for (int i = 0; i < RANDOM_OP_COUNT; i++)
+	{
+		board->randomIndices[i] = NextRandom() % count;
+		board->randomPositions[i] = (Vector2){ NextRandom() % size, NextRandom() % size };
+	}
+
+	free(stack);
+	free(isReached);
+	free(masks);
+}
+
+static void FreeBoard(struct BenchBoard* board)
+{
+	free(board->grid);
+	free(board->rotations);
+	free(board->boxes);
+	free(board->visited);
+	free(board->randomIndices);
+	free(board->randomPositions);
+}
+
+static void ResetBoard(struct BenchBoard* board)
+{
+	InitBoxes(board->boxes, board->grid, board->rows, board->cols);
+	for (int i = 0; i < board->rows * board->cols; i++)
+	{
+		for (int r = 0; r < board->rotations[i]; r++) RotateBox(&board->boxes[i]);
+	}
+}
+
+static void BenchInitBoxes(struct BenchBoard* board, long iterations)
+{
+	for (long i = 0; i < iterations; i++)
+	{
+		InitBoxes(board->boxes, board->grid, board->rows, board->cols);
+	}
+	sink = board->boxes[0].id;
+}
+
+static void BenchRotateBox(struct BenchBoard* board, long iterations)
+{
+	for (long i = 0; i < iterations; i++)
+	{
+		RotateBox(&board->boxes[board->randomIndices[i % RANDOM_OP_COUNT]]);
+	}
+	sink = board->boxes[0].rotation;
+}
+
+static void BenchGetBoxIndexByPos(struct BenchBoard* board, long iterations)
+{
+	int count = board->rows * board->cols;
+	int total = 0;
+	for (long i = 0; i < iterations; i++)
+	{
+		total += GetBoxIndexByPos(board->boxes, count, board->randomPositions[i % RANDOM_OP_COUNT]);
+	}
+	sink = total;
+}
+
+// Same as the flood in UpdateWater: reset visited, then recurse from the main pipe
+static void BenchCheckForAdjacentBox(struct BenchBoard* board, long iterations)
+{
+	int count = board->rows * board->cols;
+	int root = board->cols / 2;
+	for (long i = 0; i < iterations; i++)
+	{
+		for (int j = 0; j < count; j++) board->visited[j] = (Vector2){ -1, -1 };
+		CheckForAdjacentBox(board->boxes, board->rows, board->cols, &board->boxes[root], (Vector2){ root, 0 }, board->visited);
+	}
+	sink = board->boxes[count - 1].isWaterConnected;
+}
+
+static void BenchWinCheck(struct BenchBoard* board, long iterations)
+{
+	int solved = 0;
+	for (long i = 0; i < iterations; i++)
+	{
+		solved += UpdateWater(board->boxes, board->rows, board->cols, board->visited);
+	}
+	sink = solved;
+}
+
+#if defined(__linux__)
+static int OpenCounter(unsigned long long config)
+{
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof attr;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static void RunBench(const char* name, BenchOp op, struct BenchBoard* board, int size, bool isSkipped)
+{
+	struct BenchResult* result = &results[resultCount++];
+	*result = (struct BenchResult){ .op = name, .size = size, .isSkipped = isSkipped };
+	if (isSkipped) return;
+
+	ResetBoard(board);
+
+	// Grow the batch until it runs long enough to time
+	long iterations = 1;
+	double elapsed = 0.0;
+	for (;;)
+	{
+		double start = GetSeconds();
+		op(board, iterations);
+		elapsed = GetSeconds() - start;
+		if (elapsed >= MIN_BENCH_TIME) break;
+		iterations *= elapsed > 0.0 ? (MIN_BENCH_TIME / elapsed > 10.0 ? 10 : 2) : 10;
+	}
+
+	result->iterations = iterations;
+	result->nsPerOp = elapsed * 1e9 / iterations;
+	result->opsPerSec = iterations / elapsed;
+
+#if defined(__linux__)
+	// One more run of the same batch with the cache counters on, if the kernel lets us
+	int refs = OpenCounter(PERF_COUNT_HW_CACHE_REFERENCES);
+	int misses = OpenCounter(PERF_COUNT_HW_CACHE_MISSES);
+	if (refs >= 0 && misses >= 0)
+	{
+		ioctl(refs, PERF_EVENT_IOC_RESET, 0);
+		ioctl(misses, PERF_EVENT_IOC_RESET, 0);
+		ioctl(refs, PERF_EVENT_IOC_ENABLE, 0);
+		ioctl(misses, PERF_EVENT_IOC_ENABLE, 0);
+		op(board, iterations);
+		ioctl(refs, PERF_EVENT_IOC_DISABLE, 0);
+		ioctl(misses, PERF_EVENT_IOC_DISABLE, 0);
+
+		long long refCount = 0;
+		long long missCount = 0;
+		if (read(refs, &refCount, sizeof refCount) == sizeof refCount && read(misses, &missCount, sizeof missCount) == sizeof missCount)
+		{
+			result->hasCounters = true;
+			result->cacheRefsPerOp = (double)refCount / iterations;
+			result->cacheMissesPerOp = (double)missCount / iterations;
+		}
+	}
+	if (refs >= 0) close(refs);
+	if (misses >= 0) close(misses);
+#endif
+}
+
+static void PrintResult(const struct BenchResult* result)
+{
+	if (result->isSkipped)
+	{
+		printf("%-20s %5dx%-5d %14s\n", result->op, result->size, result->size, "skipped");
+		return;
+	}
+
+	printf("%-20s %5dx%-5d %14.1f %14.0f", result->op, result->size, result->size, result->nsPerOp, result->opsPerSec);
+	if (result->hasCounters) printf(" %14.1f %14.1f\n", result->cacheRefsPerOp, result->cacheMissesPerOp);
+	else printf(" %14s %14s\n", "-", "-");
+}
+
+static bool WriteJson(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL) return false;
+
+	fprintf(file, "[\n");
+	for (int i = 0; i < resultCount; i++)
+	{
+		const struct BenchResult* result = &results[i];
+		fprintf(file, "  { \"op\": \"%s\", \"size\": %d, \"cells\": %d, \"skipped\": %s", result->op, result->size,
+			result->size * result->size, result->isSkipped ? "true" : "false");
+		if (!result->isSkipped)
+		{
+			fprintf(file, ", \"iterations\": %ld, \"ns_per_op\": %.3f, \"ops_per_sec\": %.3f", result->iterations, result->nsPerOp, result->opsPerSec);
+			if (result->hasCounters)
+			{
+				fprintf(file, ", \"cache_refs_per_op\": %.3f, \"cache_misses_per_op\": %.3f", result->cacheRefsPerOp, result->cacheMissesPerOp);
+			}
+			else
+			{
+				fprintf(file, ", \"cache_refs_per_op\": null, \"cache_misses_per_op\": null");
+			}
+		}
+		fprintf(file, " }%s\n", i + 1 < resultCount ? "," : "");
+	}
+	fprintf(file, "]\n");
+
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	printf("%-20s %11s %14s %14s %14s %14s\n", "op", "board", "ns/op", "ops/s", "cache refs/op", "misses/op");
+
+	for (int size = MIN_SIZE; size <= MAX_SIZE; size *= 2)
+	{
+		struct BenchBoard board;
+		GenerateBoard(&board, size);
+
+		bool isQuadraticSkipped = size * size > QUADRATIC_MAX_CELLS;
+		RunBench("InitBoxes", BenchInitBoxes, &board, size, false);
+		RunBench("RotateBox", BenchRotateBox, &board, size, false);
+		RunBench("GetBoxIndexByPos", BenchGetBoxIndexByPos, &board, size, false);
+		RunBench("CheckForAdjacentBox", BenchCheckForAdjacentBox, &board, size, isQuadraticSkipped);
+		RunBench("UpdateWater", BenchWinCheck, &board, size, isQuadraticSkipped);
+
+		for (int i = resultCount - 5; i < resultCount; i++) PrintResult(&results[i]);
+		fflush(stdout);
+
+		FreeBoard(&board);
+	}
+
+	if (argc > 1 && !WriteJson(argv[1]))
+	{
+		fprintf(stderr, "bench_board: cannot write %s\n", argv[1]);
+		return 1;
+	}
+
+	return 0;
+}
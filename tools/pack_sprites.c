@@ -0,0 +1,249 @@
+// Packs every sprite and font glyph the game draws into assets/sprites.png
+// and writes the matching rect tables to src/sprite_rects.h.
+// Run from the repo root, 'make sprites' does it before building the game.
+
+#include "raylib.h"
+
+#include "../src/sprites.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define OUTPUT_IMAGE "assets/sprites.png"
+#define OUTPUT_HEADER "src/sprite_rects.h"
+#define FONT_FILE "assets/m6x11.ttf"
+#define MAX_ATLAS_SIZE 4096
+#define ITEM_COUNT (SPRITE_COUNT + FONT_GLYPH_COUNT)
+
+struct SpriteSource
+{
+	const char* path;
+	Rectangle source;	// zero size = whole image
+};
+
+struct PackItem
+{
+	Color* pixels;		// source pixels
+	int pixelsWidth;
+	Rectangle source;
+	int padding;
+	Rectangle rect;		// packed position, without padding
+};
+
+static struct PackItem items[ITEM_COUNT];
+
+static struct SpriteSource GetSpriteSource(enum SpriteId id)
+{
+	if (id >= SPRITE_PIPE && id < SPRITE_PIPE + PIPE_COUNT)
+	{
+		return (struct SpriteSource){ "assets/atlas.png", { (id - SPRITE_PIPE) * 16.f, 0.f, 16.f, 16.f } };
+	}
+	if (id >= SPRITE_PIPE_WATER && id < SPRITE_PIPE_WATER + PIPE_COUNT)
+	{
+		return (struct SpriteSource){ "assets/atlas.png", { (id - SPRITE_PIPE_WATER) * 16.f, 16.f, 16.f, 16.f } };
+	}
+
+	switch (id)
+	{
+	case SPRITE_BRICKS:
+		return (struct SpriteSource){ "assets/bricks.png" };
+	case SPRITE_NOISE:
+		return (struct SpriteSource){ "assets/noise.png" };
+	default:
+		return (struct SpriteSource){ 0 };
+	}
+}
+
+// Shelf packing, tallest first. Returns false when the items don't fit.
+static bool PackItems(int* order, int width, int height)
+{
+	int x = 0;
+	int y = 0;
+	int shelfHeight = 0;
+
+	for (int i = 0; i < ITEM_COUNT; i++)
+	{
+		struct PackItem* item = &items[order[i]];
+		int itemWidth = (int)item->source.width + item->padding * 2;
+		int itemHeight = (int)item->source.height + item->padding * 2;
+
+		if (x + itemWidth > width)
+		{
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (itemWidth > width || y + itemHeight > height) return false;
+
+		item->rect = (Rectangle){ x + item->padding, y + item->padding, item->source.width, item->source.height };
+		x += itemWidth;
+		if (itemHeight > shelfHeight) shelfHeight = itemHeight;
+	}
+
+	return true;
+}
+
+static int CompareHeight(const void* a, const void* b)
+{
+	const struct PackItem* x = &items[*(const int*)a];
+	const struct PackItem* y = &items[*(const int*)b];
+	if (x->source.height != y->source.height) return (x->source.height < y->source.height) - (x->source.height > y->source.height);
+	return (x->source.width < y->source.width) - (x->source.width > y->source.width);
+}
+
+static void WriteRect(FILE* file, Rectangle rect)
+{
+	fprintf(file, "\t{ %d, %d, %d, %d },\n", (int)rect.x, (int)rect.y, (int)rect.width, (int)rect.height);
+}
+
+int main(void)
+{
+	// Sprites, sharing one decoded copy per source file
+	const char* loadedPaths[SPRITE_COUNT] = { 0 };
+	Image loadedImages[SPRITE_COUNT] = { 0 };
+	Color* loadedPixels[SPRITE_COUNT] = { 0 };
+	int loadedCount = 0;
+
+	for (int id = 0; id < SPRITE_COUNT; id++)
+	{
+		struct SpriteSource sprite = GetSpriteSource(id);
+		int loaded = 0;
+		while (loaded < loadedCount && loadedPaths[loaded] != sprite.path) loaded++;
+
+		if (loaded == loadedCount)
+		{
+			loadedImages[loaded] = LoadImage(sprite.path);
+			if (loadedImages[loaded].data == NULL)
+			{
+				fprintf(stderr, "pack_sprites: cannot load %s\n", sprite.path);
+				return 1;
+			}
+			loadedPaths[loaded] = sprite.path;
+			loadedPixels[loaded] = LoadImageColors(loadedImages[loaded]);
+			loadedCount++;
+		}
+
+		if (sprite.source.width == 0)
+		{
+			sprite.source = (Rectangle){ 0, 0, loadedImages[loaded].width, loadedImages[loaded].height };
+		}
+
+		items[id] = (struct PackItem){
+			.pixels = loadedPixels[loaded],
+			.pixelsWidth = loadedImages[loaded].width,
+			.source = sprite.source,
+			.padding = SPRITE_PADDING,
+		};
+	}
+
+	// Font glyphs as signed distance fields, stored as white with the distance in alpha (0.5 on the outline)
+	unsigned int fontSize = 0;
+	unsigned char* fontData = LoadFileData(FONT_FILE, &fontSize);
+	GlyphInfo* glyphs = LoadFontData(fontData, (int)fontSize, FONT_BASE_SIZE, NULL, FONT_GLYPH_COUNT, FONT_SDF);
+	if (glyphs == NULL)
+	{
+		fprintf(stderr, "pack_sprites: cannot load %s\n", FONT_FILE);
+		return 1;
+	}
+
+	for (int i = 0; i < FONT_GLYPH_COUNT; i++)
+	{
+		Image image = ImageCopy(glyphs[i].image);
+		ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+
+		Color* pixels = malloc(sizeof(Color) * (image.width * image.height + 1));
+		for (int p = 0; p < image.width * image.height; p++)
+		{
+			pixels[p] = (Color){ 255, 255, 255, ((unsigned char*)image.data)[p] };
+		}
+		UnloadImage(image);
+
+		items[SPRITE_COUNT + i] = (struct PackItem){
+			.pixels = pixels,
+			.pixelsWidth = image.width,
+			.source = { 0, 0, image.width, image.height },
+			.padding = FONT_GLYPH_PADDING,
+		};
+	}
+
+	// Smallest power of two atlas everything fits in
+	int order[ITEM_COUNT];
+	for (int i = 0; i < ITEM_COUNT; i++) order[i] = i;
+	qsort(order, ITEM_COUNT, sizeof order[0], CompareHeight);
+
+	int width = 64;
+	int height = 64;
+	while (!PackItems(order, width, height))
+	{
+		if (width == height) width *= 2;
+		else height *= 2;
+
+		if (height > MAX_ATLAS_SIZE)
+		{
+			fprintf(stderr, "pack_sprites: sprites don't fit in %dx%d\n", MAX_ATLAS_SIZE, MAX_ATLAS_SIZE);
+			return 1;
+		}
+	}
+
+	Image atlas = GenImageColor(width, height, BLANK);
+	Color* atlasPixels = atlas.data;
+	for (int i = 0; i < ITEM_COUNT; i++)
+	{
+		struct PackItem* item = &items[i];
+		for (int y = 0; y < (int)item->source.height; y++)
+		{
+			for (int x = 0; x < (int)item->source.width; x++)
+			{
+				atlasPixels[((int)item->rect.y + y) * width + (int)item->rect.x + x] =
+					item->pixels[((int)item->source.y + y) * item->pixelsWidth + (int)item->source.x + x];
+			}
+		}
+	}
+
+	if (!ExportImage(atlas, OUTPUT_IMAGE))
+	{
+		fprintf(stderr, "pack_sprites: cannot write %s\n", OUTPUT_IMAGE);
+		return 1;
+	}
+
+	FILE* file = fopen(OUTPUT_HEADER, "w");
+	if (file == NULL)
+	{
+		fprintf(stderr, "pack_sprites: cannot write %s\n", OUTPUT_HEADER);
+		return 1;
+	}
+
+	fprintf(file, "// Generated by tools/pack_sprites.c from the pngs in assets/ and %s, do not edit\n\n", FONT_FILE);
+	fprintf(file, "#define SPRITE_TEXTURE_WIDTH %d\n#define SPRITE_TEXTURE_HEIGHT %d\n\n", width, height);
+
+	fprintf(file, "Rectangle spriteRects[SPRITE_COUNT] = {\n");
+	for (int i = 0; i < SPRITE_COUNT; i++) WriteRect(file, items[i].rect);
+	fprintf(file, "};\n\n");
+
+	fprintf(file, "Rectangle fontGlyphRects[FONT_GLYPH_COUNT] = {\n");
+	for (int i = 0; i < FONT_GLYPH_COUNT; i++) WriteRect(file, items[SPRITE_COUNT + i].rect);
+	fprintf(file, "};\n\n");
+
+	fprintf(file, "GlyphInfo fontGlyphs[FONT_GLYPH_COUNT] = {\n");
+	for (int i = 0; i < FONT_GLYPH_COUNT; i++)
+	{
+		fprintf(file, "\t{ .value = %d, .offsetX = %d, .offsetY = %d, .advanceX = %d },\n",
+			glyphs[i].value, glyphs[i].offsetX, glyphs[i].offsetY, glyphs[i].advanceX);
+	}
+	fprintf(file, "};\n");
+	fclose(file);
+
+	printf("pack_sprites: %d sprites and %d glyphs in %dx%d\n", SPRITE_COUNT, FONT_GLYPH_COUNT, width, height);
+
+	for (int i = 0; i < FONT_GLYPH_COUNT; i++) free(items[SPRITE_COUNT + i].pixels);
+	for (int i = 0; i < loadedCount; i++)
+	{
+		UnloadImageColors(loadedPixels[i]);
+		UnloadImage(loadedImages[i]);
+	}
+	UnloadFontData(glyphs, FONT_GLYPH_COUNT);
+	UnloadFileData(fontData);
+	UnloadImage(atlas);
+
+	return 0;
+}
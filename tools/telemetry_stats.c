@@ -0,0 +1,202 @@
+// Aggregates one or more telemetry logs written by the game into plain text stats.
+// A log holds every session appended since it was deleted.
+// Usage: telemetry_stats telemetry.bin [more.bin ...]
+
+#include "../src/telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_LEVELS 256
+#define STATE_COUNT 6
+
+// Must match enum State in src/game.h
+enum State
+{
+	START,
+	HOWTO,
+	PLAYING,
+	END,
+	WON,
+	LOST,
+};
+
+static const char* stateNames[STATE_COUNT] = { "START", "HOWTO", "PLAYING", "END", "WON", "LOST" };
+
+struct LevelStats
+{
+	int attempts;
+	int wins;
+	int losses;
+	long rotations;
+	long winRotations;
+	double solveTime;
+	double minSolveTime;
+	double maxSolveTime;
+};
+
+struct Stats
+{
+	int sessions;
+	double sessionTime;
+	long events;
+	long dropped;
+	struct LevelStats levels[MAX_LEVELS];
+	long spikes[STATE_COUNT];
+	double maxSpikeMs[STATE_COUNT];
+	double spikeMs[STATE_COUNT];
+};
+
+static bool ReadLog(const char* path, struct Stats* stats)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return false;
+	}
+
+	struct TelemetryHeader header;
+	if (fread(&header, sizeof header, 1, file) != 1 || memcmp(header.magic, TELEMETRY_MAGIC, sizeof header.magic) != 0
+		|| header.version != TELEMETRY_VERSION || header.eventSize != sizeof(struct TelemetryEvent))
+	{
+		fprintf(stderr, "%s: not a telemetry log (or wrong version)\n", path);
+		fclose(file);
+		return false;
+	}
+
+	// Per session play state
+	int playingLevel = -1;
+	uint64_t playingStartUs = 0;
+	long playingRotations = 0;
+	uint64_t lastSessionUs = 0;
+
+	struct TelemetryEvent batch[TELEMETRY_BATCH_SIZE];
+	size_t count;
+	while ((count = fread(batch, sizeof(struct TelemetryEvent), TELEMETRY_BATCH_SIZE, file)) > 0)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			struct TelemetryEvent* event = &batch[i];
+			stats->events += 1;
+			if (event->type != TELEMETRY_SESSION_START) lastSessionUs = event->timeUs;
+
+			switch (event->type)
+			{
+			case TELEMETRY_SESSION_START:
+				// Sessions are appended to the same log, the clock starts over and a
+				// session that crashed mid level never finished it
+				stats->sessionTime += lastSessionUs / 1e6;
+				lastSessionUs = 0;
+				stats->sessions += 1;
+				playingLevel = -1;
+				break;
+			case TELEMETRY_SESSION_END:
+				stats->dropped += (long)event->value;
+				break;
+			case TELEMETRY_STATE_CHANGE:
+				if (event->b == PLAYING)
+				{
+					// The puzzle index is only final once PLAYING is entered
+					playingLevel = event->level;
+					playingStartUs = event->timeUs;
+					playingRotations = 0;
+					stats->levels[playingLevel].attempts += 1;
+				}
+				else if (event->a == PLAYING && playingLevel >= 0)
+				{
+					struct LevelStats* level = &stats->levels[playingLevel];
+					if (event->b == WON || event->b == END)
+					{
+						double solveTime = (event->timeUs - playingStartUs) / 1e6;
+						if (level->wins == 0 || solveTime < level->minSolveTime) level->minSolveTime = solveTime;
+						if (solveTime > level->maxSolveTime) level->maxSolveTime = solveTime;
+						level->solveTime += solveTime;
+						level->winRotations += playingRotations;
+						level->wins += 1;
+					}
+					else if (event->b == LOST)
+					{
+						level->losses += 1;
+					}
+					playingLevel = -1;
+				}
+				break;
+			case TELEMETRY_ROTATE_BOX:
+				if (playingLevel >= 0)
+				{
+					stats->levels[playingLevel].rotations += 1;
+					playingRotations += 1;
+				}
+				break;
+			case TELEMETRY_FRAME_SPIKE:
+				if (event->a < STATE_COUNT)
+				{
+					stats->spikes[event->a] += 1;
+					stats->spikeMs[event->a] += event->value;
+					if (event->value > stats->maxSpikeMs[event->a]) stats->maxSpikeMs[event->a] = event->value;
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	stats->sessionTime += lastSessionUs / 1e6;
+	fclose(file);
+	return true;
+}
+
+static void PrintStats(const struct Stats* stats)
+{
+	printf("sessions: %d, play time: %.1fs, events: %ld, dropped: %ld\n\n",
+		stats->sessions, stats->sessionTime, stats->events, stats->dropped);
+
+	printf("%-6s %9s %6s %7s %10s %12s %10s %10s %10s\n",
+		"level", "attempts", "wins", "losses", "rotations", "rot/solve", "avg solve", "min solve", "max solve");
+	for (int i = 0; i < MAX_LEVELS; i++)
+	{
+		const struct LevelStats* level = &stats->levels[i];
+		if (level->attempts == 0) continue;
+
+		if (level->wins > 0)
+		{
+			printf("%-6d %9d %6d %7d %10ld %12.1f %9.1fs %9.1fs %9.1fs\n", i + 1, level->attempts, level->wins, level->losses,
+				level->rotations, (double)level->winRotations / level->wins, level->solveTime / level->wins,
+				level->minSolveTime, level->maxSolveTime);
+		}
+		else
+		{
+			printf("%-6d %9d %6d %7d %10ld %12s %10s %10s %10s\n", i + 1, level->attempts, level->wins, level->losses,
+				level->rotations, "-", "-", "-", "-");
+		}
+	}
+
+	printf("\n%-8s %7s %10s %10s\n", "state", "spikes", "avg ms", "max ms");
+	for (int i = 0; i < STATE_COUNT; i++)
+	{
+		if (stats->spikes[i] == 0) continue;
+		printf("%-8s %7ld %10.1f %10.1f\n", stateNames[i], stats->spikes[i], stats->spikeMs[i] / stats->spikes[i], stats->maxSpikeMs[i]);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s telemetry.bin [more.bin ...]\n", argv[0]);
+		return 1;
+	}
+
+	static struct Stats stats;
+	int failed = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!ReadLog(argv[i], &stats)) failed += 1;
+	}
+
+	PrintStats(&stats);
+	return failed > 0 ? 1 : 0;
+}
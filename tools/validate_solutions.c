@@ -0,0 +1,298 @@
+// Batch validator for submitted solutions, stand-in for the leaderboard daemon.
+// Reads one submission per line from a file or stdin:
+//     <submission id> <puzzle index> <quarter turns per box, row major, e.g. 0123012301230123>
+// and writes one line per submission to stdout, in input order:
+//     <submission id> solved|unsolved|invalid
+// Input is processed in batches, each batch is split over all cores. Batches are
+// flushed as soon as stdin runs dry, so the tool can sit at the end of a pipe.
+// Usage: validate_solutions [-j threads] [submissions.txt | -]
+//        validate_solutions --generate count > submissions.txt
+
+#include "../src/cores.h"
+#include "../src/puzzles.h"
+#include "../src/validator.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_SIZE (16 * 1024 * 1024)
+#define PARALLEL_MIN_SIZE (256 * 1024) // smaller batches are not worth waking threads for
+#define MAX_THREADS 256
+
+struct Chunk
+{
+	const struct ValidatorPuzzle* puzzles;
+	const char* begin;
+	const char* end;
+
+	char* out;
+	size_t outSize;
+	size_t outCapacity;
+
+	long solved;
+	long unsolved;
+	long invalid;
+};
+
+static void Append(struct Chunk* chunk, const char* data, size_t size)
+{
+	if (chunk->outSize + size > chunk->outCapacity)
+	{
+		chunk->outCapacity = (chunk->outSize + size) * 2;
+		chunk->out = realloc(chunk->out, chunk->outCapacity);
+	}
+
+	memcpy(chunk->out + chunk->outSize, data, size);
+	chunk->outSize += size;
+}
+
+static bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Returns the result word for one line, end points at the newline or the batch end
+static const char* ValidateLine(const struct ValidatorPuzzle* puzzles, const char* p, const char* end)
+{
+	while (p < end && IsSpace(*p)) p++;
+
+	int puzzleIndex = 0;
+	const char* digits = p;
+	while (p < end && *p >= '0' && *p <= '9' && puzzleIndex < TOTAL_PUZZLES)
+	{
+		puzzleIndex = puzzleIndex * 10 + (*p++ - '0');
+	}
+	if (p == digits || puzzleIndex >= TOTAL_PUZZLES || p == end || !IsSpace(*p)) return "invalid";
+
+	const struct ValidatorPuzzle* puzzle = &puzzles[puzzleIndex];
+	while (p < end && IsSpace(*p)) p++;
+
+	uint8_t rotations[VALIDATOR_MAX_CELLS];
+	int count = 0;
+	while (p < end && *p >= '0' && *p <= '3' && count < puzzle->count)
+	{
+		rotations[count++] = *p++ - '0';
+	}
+	while (p < end && IsSpace(*p)) p++;
+	if (count != puzzle->count || p != end) return "invalid";
+
+	return ValidateRotations(puzzle, rotations) ? "solved" : "unsolved";
+}
+
+static void* ValidateChunk(void* arg)
+{
+	struct Chunk* chunk = arg;
+	const char* p = chunk->begin;
+
+	while (p < chunk->end)
+	{
+		const char* lineEnd = memchr(p, '\n', chunk->end - p);
+		if (lineEnd == NULL) lineEnd = chunk->end;
+
+		const char* id = p;
+		while (id < lineEnd && IsSpace(*id)) id++;
+		const char* idEnd = id;
+		while (idEnd < lineEnd && !IsSpace(*idEnd)) idEnd++;
+
+		if (id < lineEnd)
+		{
+			const char* result = ValidateLine(chunk->puzzles, idEnd, lineEnd);
+			if (result[0] == 's') chunk->solved += 1;
+			else if (result[0] == 'u') chunk->unsolved += 1;
+			else chunk->invalid += 1;
+
+			Append(chunk, id, idEnd - id);
+			Append(chunk, " ", 1);
+			Append(chunk, result, strlen(result));
+			Append(chunk, "\n", 1);
+		}
+
+		p = lineEnd + 1;
+	}
+
+	return NULL;
+}
+
+// Splits [data, data + size) on line boundaries and validates the pieces in parallel
+static void ValidateBatch(struct Chunk* chunks, int threadCount, const struct ValidatorPuzzle* puzzles, const char* data, size_t size)
+{
+	if (size < PARALLEL_MIN_SIZE) threadCount = 1;
+
+	const char* begin = data;
+	const char* end = data + size;
+	for (int i = 0; i < threadCount; i++)
+	{
+		const char* chunkEnd = i == threadCount - 1 ? end : data + size * (i + 1) / threadCount;
+		if (chunkEnd < begin) chunkEnd = begin;
+		while (chunkEnd < end && chunkEnd > data && chunkEnd[-1] != '\n') chunkEnd++;
+
+		chunks[i].puzzles = puzzles;
+		chunks[i].begin = begin;
+		chunks[i].end = chunkEnd;
+		chunks[i].outSize = 0;
+		begin = chunkEnd;
+	}
+
+	pthread_t threads[MAX_THREADS];
+	int started = 1;
+	for (int i = 1; i < threadCount; i++)
+	{
+		if (pthread_create(&threads[i], NULL, ValidateChunk, &chunks[i]) != 0) break;
+		started += 1;
+	}
+
+	ValidateChunk(&chunks[0]);
+	// Chunks without a thread run here
+	for (int i = started; i < threadCount; i++)
+	{
+		ValidateChunk(&chunks[i]);
+	}
+	for (int i = 1; i < started; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		fwrite(chunks[i].out, 1, chunks[i].outSize, stdout);
+	}
+	fflush(stdout);
+}
+
+// Keeps reading until the buffer is full, the input ends or no more data is waiting
+static size_t ReadBatch(int fd, char* buffer, size_t size, size_t capacity, bool* isEof)
+{
+	while (size < capacity)
+	{
+		ssize_t got = read(fd, buffer + size, capacity - size);
+		if (got <= 0)
+		{
+			*isEof = true;
+			break;
+		}
+
+		size += got;
+		if (size < capacity && got < 64 * 1024) break;
+	}
+
+	return size;
+}
+
+static int Generate(long count)
+{
+	srand((unsigned int)time(NULL));
+
+	for (long i = 0; i < count; i++)
+	{
+		char rotations[PUZZLE_ROWS * PUZZLE_COLS + 1];
+		for (int j = 0; j < PUZZLE_ROWS * PUZZLE_COLS; j++)
+		{
+			rotations[j] = '0' + (rand() & 3);
+		}
+		rotations[PUZZLE_ROWS * PUZZLE_COLS] = '\0';
+
+		printf("%ld %d %s\n", i, rand() % TOTAL_PUZZLES, rotations);
+	}
+
+	return 0;
+}
+
+static double GetSeconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv)
+{
+	int threadCount = GetCoreCount();
+	const char* path = "-";
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc)
+		{
+			return Generate(atol(argv[i + 1]));
+		}
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+		{
+			threadCount = atoi(argv[++i]);
+		}
+		else if (argv[i][0] == '-' && argv[i][1] != '\0')
+		{
+			fprintf(stderr, "usage: %s [-j threads] [submissions.txt | -]\n       %s --generate count\n", argv[0], argv[0]);
+			return 1;
+		}
+		else
+		{
+			path = argv[i];
+		}
+	}
+
+	if (threadCount < 1) threadCount = 1;
+	if (threadCount > MAX_THREADS) threadCount = MAX_THREADS;
+
+	static struct ValidatorPuzzle puzzles[TOTAL_PUZZLES];
+	for (int i = 0; i < TOTAL_PUZZLES; i++)
+	{
+		InitValidatorPuzzle(&puzzles[i], &puzzleData[i].grid[0][0], PUZZLE_ROWS, PUZZLE_COLS);
+	}
+
+	FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+
+	static struct Chunk chunks[MAX_THREADS];
+	char* buffer = malloc(BATCH_SIZE);
+	size_t size = 0;
+	bool isEof = false;
+	double startTime = GetSeconds();
+
+	while (!isEof)
+	{
+		size = ReadBatch(fileno(file), buffer, size, BATCH_SIZE, &isEof);
+
+		// Only whole lines go into a batch, the tail waits for the next read
+		size_t batchSize = size;
+		if (!isEof)
+		{
+			while (batchSize > 0 && buffer[batchSize - 1] != '\n') batchSize--;
+			if (batchSize == 0 && size == BATCH_SIZE)
+			{
+				fprintf(stderr, "line longer than %d bytes\n", BATCH_SIZE);
+				return 1;
+			}
+		}
+
+		ValidateBatch(chunks, threadCount, puzzles, buffer, batchSize);
+
+		memmove(buffer, buffer + batchSize, size - batchSize);
+		size -= batchSize;
+	}
+
+	double seconds = GetSeconds() - startTime;
+	long solved = 0, unsolved = 0, invalid = 0;
+	for (int i = 0; i < MAX_THREADS; i++)
+	{
+		solved += chunks[i].solved;
+		unsolved += chunks[i].unsolved;
+		invalid += chunks[i].invalid;
+		free(chunks[i].out);
+	}
+
+	long total = solved + unsolved + invalid;
+	fprintf(stderr, "%ld submissions: %ld solved, %ld unsolved, %ld invalid\n", total, solved, unsolved, invalid);
+	fprintf(stderr, "%.3f s, %.2f M/s on %d threads\n", seconds, seconds > 0 ? total / seconds / 1e6 : 0.0, threadCount);
+
+	free(buffer);
+	if (file != stdin) fclose(file);
+	return 0;
+}